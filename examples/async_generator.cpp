@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#include <unifex/async_generator.hpp>
+#include <unifex/for_each.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+
+using namespace unifex;
+
+namespace {
+
+// Counts copies so we can check that yielded values are passed to the
+// consumer by reference.
+struct counted {
+  explicit counted(int value) : value(value) {}
+  counted(const counted& other) : value(other.value) { ++copies; }
+
+  int value;
+  static inline int copies = 0;
+};
+
+async_generator<counted> squares(single_thread_context& context, int count) {
+  for (int i = 0; i < count; ++i) {
+    int square = co_await transform(
+        schedule(context.get_scheduler()), [i] { return i * i; });
+    counted value{square};
+    co_yield value;
+  }
+}
+
+// Re-yields the values of another stream. The generator finishes when
+// next() on the inner stream completes with done.
+async_generator<int> forward(range_stream inner) {
+  for (;;) {
+    int value = co_await next(inner);
+    co_yield value;
+  }
+}
+
+async_generator<int> failing() {
+  co_yield 1;
+  throw std::runtime_error("failing generator");
+}
+
+} // namespace
+
+int main() {
+  single_thread_context context;
+
+  int sum = 0;
+  sync_wait(for_each(squares(context, 10), [&](const counted& value) {
+    sum += value.value;
+  }));
+  std::printf("sum of squares = %i, copies = %i\n", sum, counted::copies);
+  if (sum != 285 || counted::copies != 0) {
+    return 1;
+  }
+
+  auto total = sync_wait(reduce_stream(
+      forward(range_stream{0, 10}), 0, [](int state, int value) {
+        return state + value;
+      }));
+  std::printf("forwarded total = %i\n", *total);
+  if (*total != 45) {
+    return 1;
+  }
+
+  try {
+    sync_wait(for_each(failing(), [](int) {}));
+    return 1;
+  } catch (const std::runtime_error& e) {
+    std::printf("error: %s\n", e.what());
+  }
+
+  return 0;
+}
+
+#else // UNIFEX_NO_COROUTINES
+
+#include <cstdio>
+
+int main() {
+  std::printf(
+      "This test only supported for compilers that support coroutines\n");
+  return 0;
+}
+
+#endif // UNIFEX_NO_COROUTINES
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_mutex.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/trampoline_scheduler.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+
+// Measures the cost of a lock/unlock pair, uncontended and from several
+// threads, for std::mutex, for async_mutex waited on with sync_wait() and
+// for async_mutex with waiters resumed through a trampoline_scheduler.
+//
+// Note that async_mutex hands the lock to waiters in FIFO order, so under
+// contention each unlock() wakes the next waiting thread rather than
+// letting a running thread barge in as std::mutex does.
+
+namespace {
+
+constexpr int iterations = 50'000;
+
+template <typename Func>
+double ns_per_lock(int threadCount, Func lockIncrementUnlock) {
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount);
+  for (int t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < iterations; ++i) {
+        lockIncrementUnlock();
+      }
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    end - start)
+                    .count()) /
+      (double(threadCount) * iterations);
+}
+
+} // namespace
+
+int main() {
+  bool ok = true;
+  for (int threadCount : {1, 8}) {
+    const long expected = long(threadCount) * iterations;
+
+    std::mutex stdMutex;
+    long stdCount = 0;
+    double stdNs = ns_per_lock(threadCount, [&] {
+      std::lock_guard lock{stdMutex};
+      ++stdCount;
+    });
+    std::printf(
+        "%.1f ns per lock with std::mutex (%d threads)\n", stdNs, threadCount);
+
+    async_mutex asyncMutex;
+    long asyncCount = 0;
+    double asyncNs = ns_per_lock(threadCount, [&] {
+      sync_wait(asyncMutex.async_lock());
+      ++asyncCount;
+      asyncMutex.unlock();
+    });
+    std::printf(
+        "%.1f ns per lock with async_mutex (%d threads)\n",
+        asyncNs,
+        threadCount);
+
+    long trampolineCount = 0;
+    double trampolineNs = ns_per_lock(threadCount, [&] {
+      sync_wait(asyncMutex.async_lock_on(trampoline_scheduler{}));
+      ++trampolineCount;
+      asyncMutex.unlock();
+    });
+    std::printf(
+        "%.1f ns per lock with async_mutex resumed on a trampoline "
+        "(%d threads)\n",
+        trampolineNs,
+        threadCount);
+
+    ok &= stdCount == expected && asyncCount == expected &&
+        trampolineCount == expected;
+  }
+
+  return ok ? 0 : 1;
+}
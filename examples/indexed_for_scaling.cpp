@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/indexed_for.hpp>
+#include <unifex/just.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+
+namespace execution {
+class sequenced_policy {};
+class parallel_policy {};
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+} // namespace execution
+
+// Measures how a parallel indexed_for() scales with the number of threads
+// in the static_thread_pool it runs on.
+//
+// Usage: indexed_for_scaling [max-threads]
+
+struct index_range {
+  struct iterator {
+    using value_type = std::size_t;
+    using reference = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using iterator_category = std::random_access_iterator_tag;
+
+    std::size_t operator[](std::size_t offset) const {
+      return base_ + offset;
+    }
+
+    std::size_t base_;
+  };
+
+  iterator begin() const {
+    return iterator{0};
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  std::size_t size_;
+};
+
+int main(int argc, char** argv) {
+  constexpr std::size_t elementCount = 1 << 20;
+  constexpr int iterations = 5;
+
+  unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  if (argc > 1) {
+    maxThreads = static_cast<unsigned>(std::max(std::atoi(argv[1]), 1));
+  }
+
+  std::vector<double> data(elementCount, 1.0);
+  double baselineNs = 0;
+
+  for (unsigned threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+    static_thread_pool pool{threadCount};
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      sync_wait(indexed_for(
+          just(),
+          execution::par,
+          index_range{elementCount},
+          [&](std::size_t idx) { data[idx] = std::sqrt(data[idx] + 1.0); },
+          pool.get_scheduler()));
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = double(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count()) / iterations;
+    if (threadCount == 1) {
+      baselineNs = ns;
+    }
+
+    std::printf(
+        "%2u threads: %8.0f us per pass (%.2fx)\n",
+        threadCount,
+        ns / 1000,
+        baselineNs / ns);
+  }
+
+  return 0;
+}
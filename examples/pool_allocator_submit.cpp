@@ -0,0 +1,90 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/get_allocator.hpp>
+#include <unifex/pool_allocator.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/submit.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+using namespace unifex;
+
+// Compares the throughput of submit() when the detached operation-states
+// are allocated with std::allocator vs. pool_allocator.
+//
+// The operation-states are allocated on the main thread and freed on the
+// thread-pool's thread, so this also exercises the pool's cross-thread
+// free path.
+
+template <typename Allocator>
+struct countdown_receiver {
+  std::atomic<std::size_t>* remaining_;
+
+  void set_value() noexcept {
+    remaining_->fetch_sub(1, std::memory_order_release);
+  }
+  [[noreturn]] void set_done() noexcept {
+    std::terminate();
+  }
+  template <typename Error>
+  [[noreturn]] void set_error(Error&&) noexcept {
+    std::terminate();
+  }
+
+  friend Allocator tag_invoke(
+      tag_t<get_allocator>, const countdown_receiver&) noexcept {
+    return Allocator{};
+  }
+};
+
+template <typename Allocator>
+void run(const char* name, static_thread_pool::scheduler tp) {
+  constexpr std::size_t taskCount = 200'000;
+  std::atomic<std::size_t> remaining{taskCount};
+
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < taskCount; ++i) {
+    submit(schedule(tp), countdown_receiver<Allocator>{&remaining});
+  }
+  while (remaining.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  std::printf(
+      "%-16s %zu submits in %lld us (%.1f ns/submit)\n",
+      name,
+      taskCount,
+      static_cast<long long>(ns / 1000),
+      double(ns) / double(taskCount));
+}
+
+int main() {
+  static_thread_pool tpContext{1};
+  auto tp = tpContext.get_scheduler();
+
+  run<std::allocator<std::byte>>("std::allocator", tp);
+  run<pool_allocator<std::byte>>("pool_allocator", tp);
+
+  return 0;
+}
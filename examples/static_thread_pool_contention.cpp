@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/submit.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+
+// Micro-benchmark that hammers the static_thread_pool's per-worker queues
+// from several producer threads at once.
+//
+// The interesting numbers come from running it under 'perf c2c record'
+// and comparing the number of HITM (modified cache-line hits) reported for
+// the pool's thread_state objects, but the throughput printed here is also
+// sensitive to false-sharing between neighbouring workers.
+
+struct countdown_receiver {
+  std::atomic<std::size_t>* remaining_;
+
+  void set_value() noexcept {
+    remaining_->fetch_sub(1, std::memory_order_release);
+  }
+  [[noreturn]] void set_done() noexcept {
+    std::terminate();
+  }
+  template <typename Error>
+  [[noreturn]] void set_error(Error&&) noexcept {
+    std::terminate();
+  }
+};
+
+int main() {
+  constexpr std::size_t producerCount = 4;
+  constexpr std::size_t tasksPerProducer = 50'000;
+
+  static_thread_pool tpContext{4};
+  auto tp = tpContext.get_scheduler();
+
+  std::atomic<std::size_t> remaining{producerCount * tasksPerProducer};
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> producers;
+  for (std::size_t i = 0; i < producerCount; ++i) {
+    producers.emplace_back([&] {
+      for (std::size_t j = 0; j < tasksPerProducer; ++j) {
+        submit(schedule(tp), countdown_receiver{&remaining});
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  while (remaining.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+  std::printf(
+      "%zu tasks from %zu producers in %lld us (%.1f ns/task)\n",
+      producerCount * tasksPerProducer,
+      producerCount,
+      static_cast<long long>(ns / 1000),
+      double(ns) / double(producerCount * tasksPerProducer));
+
+  return 0;
+}
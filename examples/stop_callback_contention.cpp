@@ -0,0 +1,68 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/inplace_stop_token.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+
+// Measures the cost of registering and deregistering stop callbacks from
+// many threads against a single inplace_stop_source on which stop is never
+// requested, as when_all() and friends do when fanning out.
+
+int main() {
+  constexpr int threadCount = 64;
+  constexpr int iterations = 20'000;
+
+  inplace_stop_source source;
+  std::atomic<bool> go{false};
+  std::atomic<long> calls{0};
+
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount);
+  for (int t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      auto token = source.get_token();
+      for (int i = 0; i < iterations; ++i) {
+        inplace_stop_callback cb{token, [&] { ++calls; }};
+      }
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double ns =
+      double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                 .count()) /
+      (double(threadCount) * iterations);
+  std::printf(
+      "%.1f ns per callback registration with %d threads\n", ns, threadCount);
+
+  // No callback should have run as stop was never requested.
+  return calls.load() == 0 ? 0 : 1;
+}
@@ -93,6 +93,10 @@ int main() {
     polymorphic_allocator<char> alloc{&res};
     test(thread.get_scheduler(), alloc);
 
+    // The operation-states are freed on the context's thread after the
+    // result has been delivered, so wait for that thread to go idle.
+    sync_wait(schedule(thread.get_scheduler()));
+
     // Check that it freed all the memory it allocated
     if (res.total_allocated_bytes() != 0) {
       std::printf("error: didn't free all memory!\n");
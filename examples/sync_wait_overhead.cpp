@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/manual_event_loop.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace unifex;
+
+// Measures the cost of a sync_wait() whose sender completes on another
+// thread, and of a sync_wait_on() that runs the work inline on the
+// calling thread instead.
+
+template <typename Func>
+double best_ns_per_iteration(int iterations, Func func) {
+  // Report the fastest of several runs to reduce scheduling noise.
+  double bestNs = 0;
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      func(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           end - start)
+                           .count()) /
+        iterations;
+    if (run == 0 || ns < bestNs) {
+      bestNs = ns;
+    }
+  }
+  return bestNs;
+}
+
+int main() {
+  constexpr int iterations = 20'000;
+
+  single_thread_context thread;
+  long sum = 0;
+  double threadNs = best_ns_per_iteration(iterations, [&](int i) {
+    sum += *sync_wait(
+        transform(schedule(thread.get_scheduler()), [i] { return i; }));
+  });
+  std::printf("%.1f ns per sync_wait() via another thread\n", threadNs);
+
+  manual_event_loop loop;
+  double inlineNs = best_ns_per_iteration(iterations, [&](int i) {
+    sum += *sync_wait_on(loop, transform(schedule(), [i] { return i; }));
+  });
+  std::printf("%.1f ns per sync_wait_on(manual_event_loop)\n", inlineNs);
+
+  std::printf("checksum %ld\n", sum);
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#include <unifex/awaitable_sender.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/task.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+
+using namespace unifex;
+
+// Measures the cost per frame of a recursive chain of tasks whose frames
+// come from the default frame pool, compared with frames allocated from
+// std::allocator (ie. the global heap) via std::allocator_arg.
+
+task<long> pooled_chain(int depth) {
+  if (depth == 0) {
+    co_return 0;
+  }
+  co_return depth + co_await pooled_chain(depth - 1);
+}
+
+task<long>
+heap_chain(std::allocator_arg_t, std::allocator<std::byte> a, int depth) {
+  if (depth == 0) {
+    co_return 0;
+  }
+  co_return depth + co_await heap_chain(std::allocator_arg, a, depth - 1);
+}
+
+task<void> void_chain(int depth, long& sum) {
+  if (depth > 0) {
+    sum += depth;
+    co_await void_chain(depth - 1, sum);
+  }
+}
+
+template <typename Func>
+double best_ns_per_frame(int frames, Func func) {
+  // Report the fastest of several runs to reduce scheduling noise.
+  double bestNs = 0;
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           end - start)
+                           .count()) /
+        frames;
+    if (run == 0 || ns < bestNs) {
+      bestNs = ns;
+    }
+  }
+  return bestNs;
+}
+
+int main() {
+  constexpr int depth = 1'000;
+  constexpr int repetitions = 200;
+  constexpr long expected = long(depth) * (depth + 1) / 2;
+
+  bool ok = true;
+
+  double pooledNs = best_ns_per_frame(depth * repetitions, [&] {
+    for (int i = 0; i < repetitions; ++i) {
+      ok &= *sync_wait(awaitable_sender(pooled_chain(depth))) == expected;
+    }
+  });
+  std::printf("%.1f ns per pooled task frame\n", pooledNs);
+
+  double heapNs = best_ns_per_frame(depth * repetitions, [&] {
+    for (int i = 0; i < repetitions; ++i) {
+      ok &= *sync_wait(awaitable_sender(heap_chain(
+                std::allocator_arg, std::allocator<std::byte>{}, depth))) ==
+          expected;
+    }
+  });
+  std::printf("%.1f ns per heap-allocated task frame\n", heapNs);
+
+  long sum = 0;
+  sync_wait(awaitable_sender(void_chain(depth, sum)));
+  ok &= sum == expected;
+
+  return ok ? 0 : 1;
+}
+
+#else // UNIFEX_NO_COROUTINES
+
+#include <cstdio>
+
+int main() {
+  std::printf(
+      "This test only supported for compilers that support coroutines\n");
+  return 0;
+}
+
+#endif // UNIFEX_NO_COROUTINES
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/just.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/when_all.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <tuple>
+#include <variant>
+
+using namespace unifex;
+
+// Measures the size of a when_all() operation-state and the cost of
+// connecting, starting and completing one when all of its children
+// complete inline.
+
+struct sum_receiver {
+  long* sum_;
+
+  template <typename... Variants>
+  void set_value(Variants&&... variants) noexcept {
+    ((*sum_ += std::get<0>(std::get<0>(variants))), ...);
+  }
+  [[noreturn]] void set_done() noexcept {
+    std::terminate();
+  }
+  template <typename Error>
+  [[noreturn]] void set_error(Error&&) noexcept {
+    std::terminate();
+  }
+};
+
+int main() {
+  constexpr int iterations = 1'000'000;
+
+  using op_t = operation_t<
+      decltype(when_all(just(1), just(2), just(3), just(4))),
+      sum_receiver>;
+  std::printf("sizeof(when_all operation of 4 x just(int)): %zu\n", sizeof(op_t));
+
+  // Report the fastest of several runs to reduce scheduling noise.
+  long sum = 0;
+  double bestNs = 0;
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      auto op = connect(
+          when_all(just(i), just(1), just(2), just(3)), sum_receiver{&sum});
+      unifex::start(op);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           end - start)
+                           .count()) /
+        iterations;
+    if (run == 0 || ns < bestNs) {
+      bestNs = ns;
+    }
+  }
+
+  std::printf("%.1f ns per when_all (checksum %ld)\n", bestNs, sum);
+
+  return 0;
+}
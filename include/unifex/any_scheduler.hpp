@@ -0,0 +1,312 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/any_sender_of.hpp>
+#include <unifex/any_unique.hpp>
+#include <unifex/config.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/this.hpp>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _any_sched {
+
+inline constexpr struct _schedule_fn {
+  using type_erased_signature_t = any_sender_of<>(const this_&);
+
+  template <
+      typename Scheduler,
+      std::enable_if_t<is_tag_invocable_v<_schedule_fn, const Scheduler&>, int> =
+          0>
+  any_sender_of<> operator()(const Scheduler& s) const {
+    return tag_invoke(_schedule_fn{}, s);
+  }
+
+  template <
+      typename Scheduler,
+      std::enable_if_t<!is_tag_invocable_v<_schedule_fn, const Scheduler&>, int> =
+          0>
+  any_sender_of<> operator()(const Scheduler& s) const {
+    return any_sender_of<>{schedule(s)};
+  }
+} _schedule{};
+
+// Copy the object into 'buffer' if it fits, otherwise onto the heap.
+inline constexpr struct _copy_fn {
+  using type_erased_signature_t = void*(const this_&, void*);
+
+  template <typename T>
+  void* operator()(const T& obj, void* buffer) const {
+    return tag_invoke(_copy_fn{}, obj, buffer);
+  }
+} _copy{};
+
+// Identifies the concrete type.
+inline constexpr struct _type_id_fn {
+  using type_erased_signature_t = const void*(const this_&) noexcept;
+
+  template <typename T>
+  const void* operator()(const T& obj) const noexcept {
+    return tag_invoke(_type_id_fn{}, obj);
+  }
+} _type_id{};
+
+// Compare with another object of the same concrete type, using the
+// scheduler's operator== if it has one. Schedulers of the same type that
+// cannot be compared are considered equal.
+inline constexpr struct _equal_fn {
+  using type_erased_signature_t = bool(const this_&, const void*) noexcept;
+
+  template <typename T>
+  bool operator()(const T& obj, const void* other) const noexcept {
+    return tag_invoke(_equal_fn{}, obj, other);
+  }
+} _equal{};
+
+inline constexpr std::size_t inline_size = 2 * sizeof(void*);
+
+template <typename T>
+inline constexpr bool fits_inline = sizeof(T) <= inline_size &&
+    alignof(T) <= alignof(std::max_align_t) &&
+    std::is_nothrow_copy_constructible_v<T> &&
+    std::is_nothrow_move_constructible_v<T>;
+
+template <typename T>
+inline constexpr char type_tag = 0;
+
+template <typename T, typename = void>
+inline constexpr bool is_equality_comparable_v = false;
+
+template <typename T>
+inline constexpr bool is_equality_comparable_v<
+    T,
+    std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>> =
+    true;
+
+template <typename Scheduler>
+struct _impl {
+  struct type final
+    : private _any_unique::with_forwarding_tag_invoke<type, _schedule_fn> {
+    explicit type(const Scheduler& s) : value(s) {}
+    explicit type(Scheduler&& s) noexcept(
+        std::is_nothrow_move_constructible_v<Scheduler>)
+      : value(std::move(s)) {}
+
+    friend void tag_invoke(_any_unique::deallocate_cpo, type&& impl) noexcept {
+      if constexpr (fits_inline<type>) {
+        impl.~type();
+      } else {
+        delete &impl;
+      }
+    }
+
+    friend void*
+    tag_invoke(_any_unique::relocate_cpo, type&& impl, void* buffer) noexcept {
+      if constexpr (fits_inline<type>) {
+        type* moved = ::new (buffer) type{std::move(impl.value)};
+        impl.~type();
+        return moved;
+      } else {
+        // Heap-allocated schedulers are never moved, ownership of the
+        // allocation is just transferred.
+        (void)buffer;
+        return &impl;
+      }
+    }
+
+    friend void* tag_invoke(_copy_fn, const type& impl, void* buffer) {
+      if constexpr (fits_inline<type>) {
+        return ::new (buffer) type{impl.value};
+      } else {
+        (void)buffer;
+        return new type{impl.value};
+      }
+    }
+
+    friend const void* tag_invoke(_type_id_fn, const type&) noexcept {
+      return &type_tag<type>;
+    }
+
+    friend bool
+    tag_invoke(_equal_fn, const type& impl, const void* other) noexcept {
+      if constexpr (is_equality_comparable_v<Scheduler>) {
+        return impl.value == static_cast<const type*>(other)->value;
+      } else {
+        // Without operator== there is no way to tell schedulers of the same
+        // type apart, so they are treated as interchangeable. A copy must
+        // compare equal to the scheduler it was copied from.
+        (void)impl;
+        (void)other;
+        return true;
+      }
+    }
+
+    Scheduler value;
+  };
+};
+
+class any_scheduler
+  : private _any_unique::with_type_erased_tag_invoke<
+        any_scheduler,
+        _schedule_fn> {
+ public:
+  template <
+      typename Scheduler,
+      std::enable_if_t<
+          !std::is_same_v<std::remove_cvref_t<Scheduler>, any_scheduler>,
+          int> = 0>
+  any_scheduler(Scheduler&& s)
+    : vtable_(&*vtable_holder_t::template create<
+              impl<std::remove_cvref_t<Scheduler>>>()) {
+    using impl_t = impl<std::remove_cvref_t<Scheduler>>;
+    if constexpr (fits_inline<impl_t>) {
+      impl_ = ::new (buffer()) impl_t{(Scheduler &&) s};
+    } else {
+      impl_ = new impl_t{(Scheduler &&) s};
+    }
+  }
+
+  any_scheduler(const any_scheduler& other)
+    : impl_(other.copy_to(buffer())), vtable_(other.vtable_) {}
+
+  // A moved-from any_scheduler may only be assigned to or destroyed.
+  any_scheduler(any_scheduler&& other) noexcept
+    : impl_(other.relocate_to(buffer())), vtable_(other.vtable_) {}
+
+  any_scheduler& operator=(const any_scheduler& other) {
+    if (this != &other) {
+      if (other.impl_ == nullptr || other.is_inline()) {
+        // Copying an inline scheduler cannot throw.
+        reset();
+        impl_ = other.copy_to(buffer());
+      } else {
+        void* copy = other.copy_to(nullptr);
+        reset();
+        impl_ = copy;
+      }
+      vtable_ = other.vtable_;
+    }
+    return *this;
+  }
+
+  any_scheduler& operator=(any_scheduler&& other) noexcept {
+    if (this != &other) {
+      reset();
+      impl_ = other.relocate_to(buffer());
+      vtable_ = other.vtable_;
+    }
+    return *this;
+  }
+
+  ~any_scheduler() {
+    reset();
+  }
+
+  friend any_sender_of<>
+  tag_invoke(tag_t<schedule>, const any_scheduler& s) {
+    return _schedule_fn{}(s);
+  }
+
+  friend bool
+  operator==(const any_scheduler& a, const any_scheduler& b) noexcept {
+    auto* typeIdFn = a.vtable_->template get<_type_id_fn>();
+    if (typeIdFn(_type_id_fn{}, a.impl_) !=
+        b.vtable_->template get<_type_id_fn>()(_type_id_fn{}, b.impl_)) {
+      return false;
+    }
+    return a.vtable_->template get<_equal_fn>()(_equal_fn{}, a.impl_, b.impl_);
+  }
+
+  friend bool
+  operator!=(const any_scheduler& a, const any_scheduler& b) noexcept {
+    return !(a == b);
+  }
+
+ private:
+  template <typename Scheduler>
+  using impl = typename _impl<Scheduler>::type;
+
+  using vtable_holder_t = _any_unique::indirect_vtable_holder<
+      _any_unique::deallocate_cpo,
+      _any_unique::relocate_cpo,
+      _copy_fn,
+      _type_id_fn,
+      _equal_fn,
+      _schedule_fn>;
+  using vtable_t = std::remove_cvref_t<decltype(*std::declval<vtable_holder_t>())>;
+
+  template <typename Derived, typename CPO, bool NoExcept, typename Sig>
+  friend struct _any_unique::_with_type_erased_tag_invoke;
+
+  const vtable_t* get_vtable() const noexcept {
+    return vtable_;
+  }
+
+  void* get_object_address() const noexcept {
+    return impl_;
+  }
+
+  bool is_inline() const noexcept {
+    return impl_ == static_cast<const void*>(&buffer_[0]);
+  }
+
+  void* buffer() noexcept {
+    return static_cast<void*>(&buffer_[0]);
+  }
+
+  void* copy_to(void* buffer) const {
+    if (impl_ == nullptr) {
+      return nullptr;
+    }
+    return vtable_->template get<_copy_fn>()(_copy_fn{}, impl_, buffer);
+  }
+
+  void* relocate_to(void* buffer) noexcept {
+    if (impl_ == nullptr) {
+      return nullptr;
+    }
+    auto* relocateFn = vtable_->template get<_any_unique::relocate_cpo>();
+    return relocateFn(
+        _any_unique::relocate_cpo{}, std::exchange(impl_, nullptr), buffer);
+  }
+
+  void reset() noexcept {
+    if (impl_ != nullptr) {
+      auto* deallocateFn =
+          vtable_->template get<_any_unique::deallocate_cpo>();
+      deallocateFn(_any_unique::deallocate_cpo{}, impl_);
+    }
+  }
+
+  void* impl_;
+  const vtable_t* vtable_;
+  alignas(std::max_align_t) unsigned char buffer_[inline_size];
+};
+
+} // namespace _any_sched
+
+// A type-erased, copyable scheduler whose schedule() returns any_sender_of<>.
+//
+// Schedulers of up to two pointers in size are stored inline.
+using _any_sched::any_scheduler;
+
+} // namespace unifex
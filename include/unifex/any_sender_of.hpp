@@ -0,0 +1,553 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/any_unique.hpp>
+#include <unifex/async_trace.hpp>
+#include <unifex/config.hpp>
+#include <unifex/get_allocator.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/this.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _any {
+
+// Type-erased operation-state and receiver interfaces shared by all
+// any_sender_of<Values...> with the same value types.
+template <typename... Values>
+struct _erased {
+  struct receiver_base {
+    virtual void set_value(Values&&... values) noexcept = 0;
+    virtual void set_error(std::exception_ptr ex) noexcept = 0;
+    virtual void set_done() noexcept = 0;
+
+    // Allocate using the allocator of the type-erased receiver.
+    virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void
+    deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept = 0;
+
+    virtual continuation_info get_continuation_info() const noexcept = 0;
+
+    // Null if the type-erased receiver's stop token is never stoppable.
+    inplace_stop_source* stopSource_ = nullptr;
+
+    // Inline storage provided by the outer operation-state that the
+    // concrete operation-state is constructed in if it fits.
+    void* buffer_ = nullptr;
+    std::size_t bufferSize_ = 0;
+
+   protected:
+    ~receiver_base() = default;
+  };
+
+  // The concrete operation-state, allocated once per connect().
+  struct op_base {
+    virtual void start() noexcept = 0;
+    virtual void destroy(receiver_base& receiver) noexcept = 0;
+
+   protected:
+    ~op_base() = default;
+  };
+
+  // An allocator that forwards to the allocator of the type-erased receiver.
+  template <typename T>
+  class allocator {
+   public:
+    using value_type = T;
+
+    explicit allocator(receiver_base& receiver) noexcept
+      : receiver_(&receiver) {}
+
+    template <typename U>
+    allocator(const allocator<U>& other) noexcept
+      : receiver_(other.receiver_) {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+      if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+        throw std::bad_array_new_length{};
+      }
+      return static_cast<T*>(receiver_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+      receiver_->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    friend bool operator==(const allocator& a, const allocator<U>& b) noexcept {
+      return a.receiver_ == b.receiver_;
+    }
+
+    template <typename U>
+    friend bool operator!=(const allocator& a, const allocator<U>& b) noexcept {
+      return a.receiver_ != b.receiver_;
+    }
+
+   private:
+    template <typename U>
+    friend class allocator;
+
+    receiver_base* receiver_;
+  };
+
+  // The receiver that the concrete sender is connected to.
+  // Each completion costs a single indirect call.
+  struct receiver_ref {
+    receiver_base* receiver_;
+
+    void set_value(Values&&... values) && noexcept {
+      receiver_->set_value(std::move(values)...);
+    }
+
+    template <typename... Ts>
+    void set_value(Ts&&... values) && noexcept {
+      static_assert(
+          sizeof...(Ts) == sizeof...(Values),
+          "Sender must produce the same number of values as the "
+          "any_sender_of it is stored in");
+      try {
+        receiver_->set_value(Values(static_cast<Ts&&>(values))...);
+      } catch (...) {
+        receiver_->set_error(std::current_exception());
+      }
+    }
+
+    void set_error(std::exception_ptr ex) && noexcept {
+      receiver_->set_error(std::move(ex));
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      // Type-erase any errors that come through.
+      receiver_->set_error(std::make_exception_ptr((Error &&) error));
+    }
+
+    void set_done() && noexcept {
+      receiver_->set_done();
+    }
+
+    friend inplace_stop_token
+    tag_invoke(tag_t<get_stop_token>, const receiver_ref& r) noexcept {
+      inplace_stop_source* stopSource = r.receiver_->stopSource_;
+      return stopSource != nullptr ? stopSource->get_token()
+                                   : inplace_stop_token{};
+    }
+
+    friend allocator<std::byte>
+    tag_invoke(tag_t<get_allocator>, const receiver_ref& r) noexcept {
+      return allocator<std::byte>{*r.receiver_};
+    }
+
+    template <typename Func>
+    friend void tag_invoke(
+        tag_t<visit_continuations>, const receiver_ref& r, Func&& func) {
+      visit_continuations(
+          r.receiver_->get_continuation_info(), (Func &&) func);
+    }
+  };
+
+  template <typename Sender>
+  struct _op_impl {
+    struct type final : op_base {
+      template <typename Sender2>
+      explicit type(Sender2&& sender, receiver_base& receiver)
+        : op_(connect((Sender2 &&) sender, receiver_ref{&receiver})) {}
+
+      void start() noexcept override {
+        unifex::start(op_);
+      }
+
+      void destroy(receiver_base& receiver) noexcept override {
+        if (static_cast<void*>(this) == receiver.buffer_) {
+          this->~type();
+        } else {
+          this->~type();
+          receiver.deallocate(this, sizeof(type), alignof(type));
+        }
+      }
+
+      operation_t<Sender, receiver_ref> op_;
+    };
+  };
+  template <typename Sender>
+  using op_impl = typename _op_impl<std::remove_cvref_t<Sender>>::type;
+
+  struct connect_fn {
+    using type_erased_signature_t = op_base*(this_&&, receiver_base*);
+
+    template <
+        typename Sender,
+        std::enable_if_t<
+            is_tag_invocable_v<connect_fn, Sender, receiver_base*>,
+            int> = 0>
+    op_base* operator()(Sender&& sender, receiver_base* receiver) const {
+      return tag_invoke(connect_fn{}, (Sender &&) sender, receiver);
+    }
+
+    template <
+        typename Sender,
+        std::enable_if_t<
+            !is_tag_invocable_v<connect_fn, Sender, receiver_base*>,
+            int> = 0>
+    op_base* operator()(Sender&& sender, receiver_base* receiver) const {
+      using op_t = op_impl<Sender>;
+      if constexpr (alignof(op_t) <= alignof(std::max_align_t)) {
+        if (sizeof(op_t) <= receiver->bufferSize_) {
+          return ::new (receiver->buffer_) op_t{(Sender &&) sender, *receiver};
+        }
+      }
+      void* storage = receiver->allocate(sizeof(op_t), alignof(op_t));
+      try {
+        return ::new (storage) op_t{(Sender &&) sender, *receiver};
+      } catch (...) {
+        receiver->deallocate(storage, sizeof(op_t), alignof(op_t));
+        throw;
+      }
+    }
+  };
+};
+
+// Senders are stored inline if they are no larger than this.
+inline constexpr std::size_t sender_inline_size = 4 * sizeof(void*);
+
+template <typename Receiver, std::size_t InlineSize, typename... Values>
+struct _op {
+  class type;
+};
+template <typename Receiver, std::size_t InlineSize, typename... Values>
+using operation = typename _op<
+    std::remove_cvref_t<Receiver>,
+    InlineSize,
+    Values...>::type;
+
+template <typename Receiver, std::size_t InlineSize, typename... Values>
+class _op<Receiver, InlineSize, Values...>::type final
+  : _erased<Values...>::receiver_base {
+  using erased = _erased<Values...>;
+  using receiver_base = typename erased::receiver_base;
+  using op_base = typename erased::op_base;
+
+  using stop_token_type = stop_token_type_t<Receiver&>;
+  static constexpr bool stop_possible =
+      !is_stop_never_possible_v<stop_token_type>;
+
+  struct cancel_callback {
+    inplace_stop_source& stopSource_;
+    void operator()() noexcept {
+      stopSource_.request_stop();
+    }
+  };
+  using stop_callback_type =
+      typename stop_token_type::template callback_type<cancel_callback>;
+
+  // The unit of allocation from the receiver's allocator.
+  struct alignas(std::max_align_t) block {
+    unsigned char data[alignof(std::max_align_t)];
+  };
+  using block_allocator = typename std::allocator_traits<
+      std::remove_cvref_t<get_allocator_t<const Receiver&>>>::
+      template rebind_alloc<block>;
+  using block_traits = std::allocator_traits<block_allocator>;
+
+  static std::size_t block_count(std::size_t bytes) noexcept {
+    return (bytes + sizeof(block) - 1) / sizeof(block);
+  }
+
+ public:
+  template <typename Sender, typename Receiver2>
+  explicit type(Sender&& sender, Receiver2&& receiver)
+    : receiver_((Receiver2 &&) receiver) {
+    if constexpr (stop_possible) {
+      this->stopSource_ = &ownStopSource_;
+    }
+    if constexpr (InlineSize > 0) {
+      this->buffer_ = storage_.buffer();
+      this->bufferSize_ = InlineSize;
+    }
+    op_ = typename erased::connect_fn{}(
+        (Sender &&) sender, static_cast<receiver_base*>(this));
+  }
+
+  type(type&&) = delete;
+
+  ~type() {
+    op_->destroy(*this);
+  }
+
+  void start() noexcept {
+    if constexpr (stop_possible) {
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{ownStopSource_});
+    }
+    op_->start();
+  }
+
+ private:
+  void set_value(Values&&... values) noexcept override {
+    reset_stop_callback();
+    try {
+      unifex::set_value(std::move(receiver_), std::move(values)...);
+    } catch (...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+    }
+  }
+
+  void set_error(std::exception_ptr ex) noexcept override {
+    reset_stop_callback();
+    unifex::set_error(std::move(receiver_), std::move(ex));
+  }
+
+  void set_done() noexcept override {
+    reset_stop_callback();
+    unifex::set_done(std::move(receiver_));
+  }
+
+  void* allocate(std::size_t bytes, std::size_t alignment) override {
+    block_allocator alloc{get_allocator(receiver_)};
+    if (alignment <= alignof(std::max_align_t)) {
+      return block_traits::allocate(alloc, block_count(bytes));
+    }
+
+    // Over-allocate so that there is a suitably aligned address within the
+    // allocation, and store the start of the allocation just before it.
+    // As the allocation is aligned to sizeof(block) there is always room
+    // for the pointer between the two.
+    block* allocation =
+        block_traits::allocate(alloc, block_count(bytes + alignment));
+    const std::uintptr_t aligned =
+        (reinterpret_cast<std::uintptr_t>(allocation) + alignment) &
+        ~static_cast<std::uintptr_t>(alignment - 1);
+    void* p = reinterpret_cast<void*>(aligned);
+    std::memcpy(
+        static_cast<char*>(p) - sizeof(allocation),
+        &allocation,
+        sizeof(allocation));
+    return p;
+  }
+
+  void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept
+      override {
+    block_allocator alloc{get_allocator(receiver_)};
+    if (alignment <= alignof(std::max_align_t)) {
+      block_traits::deallocate(
+          alloc, static_cast<block*>(p), block_count(bytes));
+    } else {
+      block* allocation;
+      std::memcpy(
+          &allocation,
+          static_cast<char*>(p) - sizeof(allocation),
+          sizeof(allocation));
+      block_traits::deallocate(
+          alloc, allocation, block_count(bytes + alignment));
+    }
+  }
+
+  continuation_info get_continuation_info() const noexcept override {
+    return continuation_info::from_continuation(receiver_);
+  }
+
+  void reset_stop_callback() noexcept {
+    if constexpr (stop_possible) {
+      stopCallback_.destruct();
+    }
+  }
+
+  struct empty {};
+
+  UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+  op_base* op_;
+  UNIFEX_NO_UNIQUE_ADDRESS
+      std::conditional_t<stop_possible, inplace_stop_source, empty>
+          ownStopSource_;
+  UNIFEX_NO_UNIQUE_ADDRESS
+      std::conditional_t<
+          stop_possible,
+          manual_lifetime<stop_callback_type>,
+          empty> stopCallback_;
+  UNIFEX_NO_UNIQUE_ADDRESS _any_unique::_storage<InlineSize> storage_;
+};
+
+template <std::size_t InlineSize, typename... Values>
+struct _sender {
+  class type;
+};
+
+template <std::size_t InlineSize, typename... Values>
+class _sender<InlineSize, Values...>::type {
+  using connect_fn = typename _erased<Values...>::connect_fn;
+
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<Values...>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  template <
+      typename Sender,
+      std::enable_if_t<
+          !std::is_same_v<std::remove_cvref_t<Sender>, type>,
+          int> = 0>
+  type(Sender&& sender)
+    : sender_(
+          std::in_place_type<std::remove_cvref_t<Sender>>,
+          (Sender &&) sender) {}
+
+  // Use 'alloc' to allocate the sender if it is too large to store inline.
+  template <typename Sender, typename Allocator>
+  type(std::allocator_arg_t, Allocator alloc, Sender&& sender)
+    : sender_(
+          std::allocator_arg,
+          std::move(alloc),
+          std::in_place_type<std::remove_cvref_t<Sender>>,
+          (Sender &&) sender) {}
+
+  template <typename Receiver>
+  operation<Receiver, InlineSize, Values...> connect(Receiver&& receiver) && {
+    return operation<Receiver, InlineSize, Values...>{
+        std::move(sender_), (Receiver &&) receiver};
+  }
+
+ private:
+  small_any_unique<sender_inline_size, connect_fn> sender_;
+};
+
+// The concrete sender of a shared_any_sender_of, shared by all its copies.
+template <typename... Values>
+struct _shared_base {
+  virtual ~_shared_base() = default;
+
+  // Connect a copy of the concrete sender.
+  virtual typename _erased<Values...>::op_base*
+  connect(typename _erased<Values...>::receiver_base* receiver) const = 0;
+};
+
+template <typename Sender, typename... Values>
+struct _shared_impl {
+  struct type final : _shared_base<Values...> {
+    template <typename Sender2>
+    explicit type(Sender2&& sender) : sender_((Sender2 &&) sender) {}
+
+    typename _erased<Values...>::op_base*
+    connect(typename _erased<Values...>::receiver_base* receiver)
+        const override {
+      return typename _erased<Values...>::connect_fn{}(
+          Sender(sender_), receiver);
+    }
+
+    Sender sender_;
+  };
+};
+template <typename Sender, typename... Values>
+using shared_impl = typename _shared_impl<Sender, Values...>::type;
+
+template <typename... Values>
+struct _shared_ref {
+  struct type {
+    const _shared_base<Values...>* shared_;
+
+    friend typename _erased<Values...>::op_base* tag_invoke(
+        typename _erased<Values...>::connect_fn,
+        type&& ref,
+        typename _erased<Values...>::receiver_base* receiver) {
+      return ref.shared_->connect(receiver);
+    }
+  };
+};
+
+template <typename... Values>
+struct _shared_sender {
+  class type;
+};
+
+template <typename... Values>
+class _shared_sender<Values...>::type {
+  using shared_ref = typename _shared_ref<Values...>::type;
+
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<Values...>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  template <
+      typename Sender,
+      std::enable_if_t<
+          !std::is_same_v<std::remove_cvref_t<Sender>, type>,
+          int> = 0>
+  type(Sender&& sender)
+    : shared_(std::make_shared<
+              shared_impl<std::remove_cvref_t<Sender>, Values...>>(
+          (Sender &&) sender)) {
+    static_assert(
+        std::is_copy_constructible_v<std::remove_cvref_t<Sender>>,
+        "shared_any_sender_of requires a copyable sender");
+  }
+
+  template <typename Receiver>
+  operation<Receiver, 0, Values...> connect(Receiver&& receiver) const {
+    return operation<Receiver, 0, Values...>{
+        shared_ref{shared_.get()}, (Receiver &&) receiver};
+  }
+
+ private:
+  std::shared_ptr<const _shared_base<Values...>> shared_;
+};
+
+} // namespace _any
+
+// A type-erased, move-only sender that produces Values... (or an
+// exception_ptr error, or done).
+//
+// The concrete operation-state is allocated once per connect() using the
+// allocator returned by get_allocator() on the receiver. Stop requests and
+// get_allocator() queries are forwarded to the concrete sender.
+template <typename... Values>
+using any_sender_of = typename _any::_sender<0, Values...>::type;
+
+// As any_sender_of, but concrete operation-states of up to InlineSize bytes
+// are constructed inside the type-erased operation-state without allocating.
+template <std::size_t InlineSize, typename... Values>
+using small_any_sender_of =
+    typename _any::_sender<InlineSize, Values...>::type;
+
+// As any_sender_of, but copyable. Copies share a single reference-counted
+// copy of the concrete sender, which must be copyable, and each connect()
+// connects a fresh copy of it.
+template <typename... Values>
+using shared_any_sender_of =
+    typename _any::_shared_sender<Values...>::type;
+
+} // namespace unifex
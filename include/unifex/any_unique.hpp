@@ -21,6 +21,7 @@
 #include <unifex/this.hpp>
 #include <unifex/type_traits.hpp>
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 
@@ -281,14 +282,56 @@ inline constexpr struct deallocate_cpo {
   }
 } deallocate;
 
-template <typename... CPOs>
+inline constexpr struct relocate_cpo {
+  using type_erased_signature_t = void*(this_&&, void*) noexcept;
+
+  template <
+      typename T,
+      std::enable_if_t<is_tag_invocable_v<relocate_cpo, T&&, void*>, int> = 0>
+  void* operator()(T&& obj, void* buffer) const noexcept {
+    return tag_invoke(relocate_cpo{}, std::move(obj), buffer);
+  }
+} relocate;
+
+// Storage for the type-erased object.
+//
+// If InlineSize is non-zero then objects that fit within InlineSize bytes,
+// that are no more aligned than std::max_align_t and that are nothrow
+// move-constructible are stored inline rather than being heap-allocated.
+template <std::size_t InlineSize>
+struct _storage {
+  static constexpr bool has_inline_storage = true;
+
+  template <typename T>
+  static constexpr bool fits_inline = sizeof(T) <= InlineSize &&
+      alignof(T) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<T>;
+
+  void* buffer() noexcept {
+    return static_cast<void*>(&buffer_[0]);
+  }
+
+  alignas(std::max_align_t) unsigned char buffer_[InlineSize];
+};
+
+template <>
+struct _storage<0> {
+  static constexpr bool has_inline_storage = false;
+
+  template <typename T>
+  static constexpr bool fits_inline = false;
+};
+
+template <std::size_t InlineSize, typename... CPOs>
 struct _make {
   class type;
 };
 
-template <typename... CPOs>
-class _make<CPOs...>::type
+template <std::size_t InlineSize, typename... CPOs>
+class _make<InlineSize, CPOs...>::type
   : private with_type_erased_tag_invoke<type, CPOs>... {
+  using storage_t = _storage<InlineSize>;
+
  public:
   template <typename Concrete, typename Allocator, typename... Args>
   explicit type(
@@ -299,24 +342,31 @@ class _make<CPOs...>::type
     : vtable_(vtable_holder_t::template create<
               concrete_impl<Concrete, Allocator>>()) {
     using concrete_type = concrete_impl<Concrete, Allocator>;
-    using allocator_type = typename concrete_type::allocator_type;
-    using allocator_traits = std::allocator_traits<allocator_type>;
-    allocator_type typedAllocator{std::move(alloc)};
-    auto ptr = allocator_traits::allocate(typedAllocator, 1);
-    try {
-      // TODO: Ideally we'd use allocator_traits::construct() here but
-      // that makes it difficult to provide consistent behaviour across
-      // std::allocator and std::pmr::polymorphic_allocator as the latter
-      // automatically injects the extra allocator_arg/alloc params which
-      // ends up duplicating them. But std::allocator doesn't do the same
-      // injection of the parameters.
-      ::new ((void*)ptr)
-          concrete_type{std::allocator_arg, typedAllocator, std::forward<Args>(args)...};
-    } catch (...) {
-      allocator_traits::deallocate(typedAllocator, ptr, 1);
-      throw;
+    if constexpr (storage_t::template fits_inline<concrete_type>) {
+      // Small enough to store inline, no need to allocate.
+      (void)alloc;
+      impl_ = ::new (storage_.buffer())
+          concrete_type{std::forward<Args>(args)...};
+    } else {
+      using allocator_type = typename concrete_type::allocator_type;
+      using allocator_traits = std::allocator_traits<allocator_type>;
+      allocator_type typedAllocator{std::move(alloc)};
+      auto ptr = allocator_traits::allocate(typedAllocator, 1);
+      try {
+        // TODO: Ideally we'd use allocator_traits::construct() here but
+        // that makes it difficult to provide consistent behaviour across
+        // std::allocator and std::pmr::polymorphic_allocator as the latter
+        // automatically injects the extra allocator_arg/alloc params which
+        // ends up duplicating them. But std::allocator doesn't do the same
+        // injection of the parameters.
+        ::new ((void*)ptr)
+            concrete_type{std::allocator_arg, typedAllocator, std::forward<Args>(args)...};
+      } catch (...) {
+        allocator_traits::deallocate(typedAllocator, ptr, 1);
+        throw;
+      }
+      impl_ = static_cast<void*>(ptr);
     }
-    impl_ = static_cast<void*>(ptr);
   }
 
   template <
@@ -350,7 +400,19 @@ class _make<CPOs...>::type
           std::move(concrete)) {}
 
   type(type&& other) noexcept
-    : impl_(std::exchange(other.impl_, nullptr)), vtable_(other.vtable_) {}
+    : impl_(nullptr), vtable_(other.vtable_) {
+    if constexpr (storage_t::has_inline_storage) {
+      if (other.impl_ != nullptr) {
+        // Either move the object into our inline storage or take
+        // ownership of its heap-allocation.
+        auto* relocateFn = vtable_->template get<relocate_cpo>();
+        impl_ = relocateFn(
+            relocate_cpo{}, std::exchange(other.impl_, nullptr), storage_.buffer());
+      }
+    } else {
+      impl_ = std::exchange(other.impl_, nullptr);
+    }
+  }
 
   ~type() {
     if (impl_ != nullptr) {
@@ -360,10 +422,36 @@ class _make<CPOs...>::type
   }
 
  private:
-  using vtable_holder_t = vtable_holder<deallocate_cpo, CPOs...>;
+  using vtable_holder_t = std::conditional_t<
+      storage_t::has_inline_storage,
+      vtable_holder<deallocate_cpo, relocate_cpo, CPOs...>,
+      vtable_holder<deallocate_cpo, CPOs...>>;
+
+  template <typename Concrete>
+  struct _inline_concrete_impl {
+    struct type final
+      : private with_forwarding_tag_invoke<type, CPOs>... {
+      template <typename... Args>
+      explicit type(Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<Concrete, Args...>)
+        : value(std::forward<Args>(args)...) {}
+
+      friend void tag_invoke(deallocate_cpo, type&& impl) noexcept {
+        impl.~type();
+      }
+
+      friend void* tag_invoke(relocate_cpo, type&& impl, void* buffer) noexcept {
+        type* moved = ::new (buffer) type{std::move(impl.value)};
+        impl.~type();
+        return moved;
+      }
+
+      UNIFEX_NO_UNIQUE_ADDRESS Concrete value;
+    };
+  };
 
   template <typename Concrete, typename Allocator>
-  struct _concrete_impl {
+  struct _heap_concrete_impl {
     struct type final
       : private with_forwarding_tag_invoke<type, CPOs>... {
       using allocator_type = typename std::allocator_traits<
@@ -385,12 +473,22 @@ class _make<CPOs...>::type
             allocCopy, &impl, 1);
       }
 
+      // Heap-allocated objects are never moved, ownership of the
+      // allocation is just transferred.
+      friend void* tag_invoke(relocate_cpo, type&& impl, void*) noexcept {
+        return &impl;
+      }
+
       UNIFEX_NO_UNIQUE_ADDRESS Concrete value;
       UNIFEX_NO_UNIQUE_ADDRESS allocator_type alloc;
     };
   };
   template <typename Concrete, typename Allocator>
-  using concrete_impl = typename _concrete_impl<Concrete, Allocator>::type;
+  using concrete_impl = typename std::conditional_t<
+      storage_t::template fits_inline<
+          typename _inline_concrete_impl<Concrete>::type>,
+      _inline_concrete_impl<Concrete>,
+      _heap_concrete_impl<Concrete, Allocator>>::type;
 
   template <typename Derived, typename CPO, bool NoExcept, typename Sig>
   friend struct _with_type_erased_tag_invoke;
@@ -405,13 +503,25 @@ class _make<CPOs...>::type
 
   void* impl_;
   vtable_holder_t vtable_;
+  UNIFEX_NO_UNIQUE_ADDRESS storage_t storage_;
 };
 } // namespace _any_unique
 
+// A type-erased, move-only wrapper that always heap-allocates the
+// wrapped object.
 template <typename... CPOs>
-using any_unique = typename _any_unique::_make<CPOs...>::type;
+using any_unique = typename _any_unique::_make<0, CPOs...>::type;
 
 template <auto&... CPOs>
 using any_unique_t = any_unique<tag_t<CPOs>...>;
 
+// As any_unique, but objects of up to InlineSize bytes that are nothrow
+// move-constructible are stored inline without allocating.
+template <std::size_t InlineSize, typename... CPOs>
+using small_any_unique =
+    typename _any_unique::_make<InlineSize, CPOs...>::type;
+
+template <std::size_t InlineSize, auto&... CPOs>
+using small_any_unique_t = small_any_unique<InlineSize, tag_t<CPOs>...>;
+
 } // namespace unifex
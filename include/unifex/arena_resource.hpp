@@ -0,0 +1,134 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/detail/hardware_interference_size.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace unifex {
+
+// A monotonic arena for operation-states.
+//
+// Memory is handed out by bumping a pointer through fixed-size chunks.
+// Each chunk is an epoch: once the arena has moved on to a new chunk and
+// every allocation made from the old chunk has been deallocated, the old
+// chunk is reset in O(1) and recycled.
+//
+// allocate() must only be called by one thread at a time (typically the
+// thread that owns the arena). deallocate() may be called from any thread
+// and costs a single atomic decrement.
+//
+// All allocations must be deallocated before the arena is destroyed.
+class arena_resource {
+public:
+  static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+  explicit arena_resource(std::size_t chunkSize = default_chunk_size) noexcept
+    : chunkSize_(chunkSize) {}
+
+  arena_resource(const arena_resource&) = delete;
+  arena_resource(arena_resource&&) = delete;
+  arena_resource& operator=(const arena_resource&) = delete;
+  arena_resource& operator=(arena_resource&&) = delete;
+
+  ~arena_resource();
+
+  [[nodiscard]] void* allocate(
+      std::size_t bytes,
+      std::size_t alignment = alignof(std::max_align_t));
+
+  // Does not need the arena the memory was allocated from.
+  static void deallocate(void* p) noexcept;
+
+  void deallocate(void* p, std::size_t, std::size_t = 0) noexcept {
+    arena_resource::deallocate(p);
+  }
+
+private:
+  struct chunk;
+
+  void* allocate_slow(std::size_t bytes, std::size_t alignment);
+  void retire_current() noexcept;
+  chunk* acquire_chunk(std::size_t minSize);
+  void recycle(chunk* c) noexcept;
+
+  ////////
+  // Data only accessed by the allocating thread.
+
+  const std::size_t chunkSize_;
+  chunk* current_ = nullptr;
+  char* next_ = nullptr;
+  char* end_ = nullptr;
+  std::size_t allocationCount_ = 0;
+
+  // Drained chunks available for reuse.
+  chunk* spareChunks_ = nullptr;
+
+  // Every chunk owned by this arena, for destruction.
+  chunk* allChunks_ = nullptr;
+
+  ////////
+  // Data written by threads deallocating the last allocation of a chunk.
+
+  alignas(hardware_destructive_interference_size)
+      std::atomic<chunk*> recycledChunks_{nullptr};
+};
+
+template <typename T>
+class arena_allocator {
+public:
+  using value_type = T;
+
+  explicit arena_allocator(arena_resource& arena) noexcept : arena_(&arena) {}
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U>& other) noexcept
+    : arena_(other.arena_) {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+      throw std::bad_array_new_length{};
+    }
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept {
+    arena_resource::deallocate(p);
+  }
+
+  template <typename U>
+  friend bool
+  operator==(const arena_allocator& a, const arena_allocator<U>& b) noexcept {
+    return a.arena_ == b.arena_;
+  }
+
+  template <typename U>
+  friend bool
+  operator!=(const arena_allocator& a, const arena_allocator<U>& b) noexcept {
+    return a.arena_ != b.arena_;
+  }
+
+private:
+  template <typename U>
+  friend class arena_allocator;
+
+  arena_resource* arena_;
+};
+
+} // namespace unifex
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/detail/async_waiter.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace unifex {
+
+// A reusable barrier for a fixed number of participants. Each phase
+// completes once every participant has arrived, at which point the
+// participants waiting in that phase are resumed and the barrier resets
+// for the next phase.
+class async_barrier {
+public:
+  explicit async_barrier(std::ptrdiff_t expected) noexcept;
+  async_barrier(const async_barrier &) = delete;
+  async_barrier(async_barrier &&) = delete;
+  ~async_barrier();
+
+  async_barrier &operator=(const async_barrier &) = delete;
+  async_barrier &operator=(async_barrier &&) = delete;
+
+  // Arrive at the barrier without waiting for the current phase to
+  // complete.
+  void arrive() noexcept;
+
+  // Returns a sender that arrives at the barrier when started and completes
+  // with set_value() once the current phase completes. Waiters are resumed
+  // inline on the thread of the last participant to arrive.
+  [[nodiscard]] _async_wait::sender<void> async_arrive_and_wait() noexcept;
+
+  // As async_arrive_and_wait() but the operation is resumed by scheduling
+  // onto 'scheduler'.
+  template <typename Scheduler>
+  [[nodiscard]] _async_wait::sender<std::remove_cvref_t<Scheduler>>
+  async_arrive_and_wait_on(Scheduler &&scheduler) noexcept(
+      std::is_nothrow_constructible_v<
+          std::remove_cvref_t<Scheduler>, Scheduler>);
+
+private:
+  static bool
+  arrive_and_enqueue(void *self, _async_wait::waiter_base *waiter) noexcept;
+
+  const std::ptrdiff_t expected_;
+  std::atomic<std::ptrdiff_t> remaining_;
+  std::atomic<_async_wait::waiter_base *> waiters_{nullptr};
+};
+
+inline _async_wait::sender<void> async_barrier::async_arrive_and_wait() noexcept {
+  return _async_wait::sender<void>{
+      this, &async_barrier::arrive_and_enqueue, _async_wait::empty{}};
+}
+
+template <typename Scheduler>
+inline _async_wait::sender<std::remove_cvref_t<Scheduler>>
+async_barrier::async_arrive_and_wait_on(Scheduler &&scheduler) noexcept(
+    std::is_nothrow_constructible_v<std::remove_cvref_t<Scheduler>,
+                                    Scheduler>) {
+  return _async_wait::sender<std::remove_cvref_t<Scheduler>>{
+      this, &async_barrier::arrive_and_enqueue, (Scheduler &&) scheduler};
+}
+
+} // namespace unifex
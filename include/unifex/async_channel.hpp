@@ -0,0 +1,493 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/detail/hardware_interference_size.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/ready_done_sender.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _channel {
+
+struct waiter_base {
+  void (*resume_)(waiter_base*) noexcept;
+};
+
+// Common logic for operations that may need to wait for the other side of
+// the channel to make progress.
+//
+// Derived has a 'channel_' member referring to the channel and provides:
+//
+//   bool ready() noexcept
+//     Attempts to make progress, and keeps returning true once it has.
+//
+//   static bool can_progress(const Channel& c) noexcept
+//     Returns whether ready() would now make progress, without modifying
+//     anything.
+//
+//   void complete() noexcept
+//     Delivers the result to the receiver.
+//
+// An operation that cannot make progress parks itself in a slot on the
+// channel. The other side wakes it by exchanging the slot with nullptr and
+// calling run() again. A stop-request wakes it the same way. Only the thread
+// that has taken the operation out of the slot may call ready() or
+// complete().
+template <typename Derived, typename Receiver>
+struct _waiter {
+  class type;
+};
+
+template <typename Derived, typename Receiver>
+class _waiter<Derived, Receiver>::type : protected waiter_base {
+ protected:
+  template <typename Receiver2>
+  explicit type(std::atomic<waiter_base*>& slot, Receiver2&& r) noexcept(
+      std::is_nothrow_constructible_v<Receiver, Receiver2>)
+    : receiver_((Receiver2 &&) r), slot_(slot) {
+    this->resume_ = [](waiter_base* self) noexcept {
+      static_cast<type*>(self)->run();
+    };
+  }
+
+  void start() noexcept {
+    if constexpr (stop_possible) {
+      // Pass a copy: construct() moves from its arguments and
+      // get_stop_token() may return a reference to the receiver's token.
+      stopCallback_.construct(
+          stop_token_type{get_stop_token(receiver_)}, cancel_callback{*this});
+    }
+    run();
+  }
+
+  Receiver receiver_;
+
+ private:
+  using stop_token_type = stop_token_type_t<Receiver&>;
+  static constexpr bool stop_possible =
+      !is_stop_never_possible_v<stop_token_type>;
+
+  struct cancel_callback {
+    type& op_;
+
+    void operator()() noexcept {
+      waiter_base* expected = &op_;
+      if (op_.slot_.compare_exchange_strong(
+              expected, nullptr, std::memory_order_acq_rel)) {
+        op_.run();
+      }
+    }
+  };
+
+  bool stop_requested() noexcept {
+    if constexpr (stop_possible) {
+      return get_stop_token(receiver_).stop_requested();
+    } else {
+      return false;
+    }
+  }
+
+  void run() noexcept {
+    auto& derived = *static_cast<Derived*>(this);
+    for (;;) {
+      if (derived.ready()) {
+        destroy_callback();
+        derived.complete();
+        return;
+      }
+      if (stop_requested()) {
+        destroy_callback();
+        unifex::set_done(std::move(receiver_));
+        return;
+      }
+
+      // Once the operation is in the slot it may be resumed, completed and
+      // destroyed on another thread at any time. Until it has been taken
+      // back out of the slot only check whether progress is possible, using
+      // copies of what is needed rather than the operation itself.
+      auto& channel = derived.channel_;
+      auto& slot = slot_;
+      const stop_token_type stopToken = get_stop_token(receiver_);
+      waiter_base* const self = this;
+
+      slot.store(self, std::memory_order_release);
+      // Pairs with the fence in channel::notify(): either we see the other
+      // side's progress below, or it sees us in the slot.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!Derived::can_progress(channel) && !stopToken.stop_requested()) {
+        return;
+      }
+
+      waiter_base* expected = self;
+      if (!slot.compare_exchange_strong(
+              expected, nullptr, std::memory_order_acq_rel)) {
+        // Already claimed by the other side, which will call run() again.
+        return;
+      }
+    }
+  }
+
+  void destroy_callback() noexcept {
+    if constexpr (stop_possible) {
+      stopCallback_.destruct();
+    }
+  }
+
+  struct empty {};
+
+  std::atomic<waiter_base*>& slot_;
+  UNIFEX_NO_UNIQUE_ADDRESS std::conditional_t<
+      stop_possible,
+      manual_lifetime<
+          typename stop_token_type::template callback_type<cancel_callback>>,
+      empty>
+      stopCallback_;
+};
+
+template <typename T>
+class channel;
+
+template <typename T, typename Receiver>
+struct _send_op {
+  class type;
+};
+template <typename T, typename Receiver>
+using send_operation =
+    typename _send_op<T, std::remove_cvref_t<Receiver>>::type;
+
+template <typename T, typename Receiver>
+class _send_op<T, Receiver>::type final
+  : _waiter<type, Receiver>::type {
+  using base = typename _waiter<type, Receiver>::type;
+  friend base;
+
+ public:
+  template <typename Receiver2>
+  explicit type(channel<T>& c, T&& value, Receiver2&& r)
+    : base(c.producer_, (Receiver2 &&) r),
+      channel_(c),
+      value_(std::move(value)) {}
+
+  type(type&&) = delete;
+
+  using base::start;
+
+ private:
+  bool ready() noexcept {
+    if (!done_) {
+      if (channel_.closed_.load(std::memory_order_acquire)) {
+        done_ = true;
+      } else {
+        done_ = sent_ = channel_.try_push(value_);
+      }
+    }
+    return done_;
+  }
+
+  static bool can_progress(const channel<T>& c) noexcept {
+    return c.closed_.load(std::memory_order_acquire) ||
+        c.tail_.load(std::memory_order_relaxed) -
+            c.head_.load(std::memory_order_acquire) <=
+        c.mask_;
+  }
+
+  void complete() noexcept {
+    if (sent_) {
+      unifex::set_value(std::move(this->receiver_));
+    } else {
+      unifex::set_done(std::move(this->receiver_));
+    }
+  }
+
+  channel<T>& channel_;
+  T value_;
+  bool done_ = false;
+  bool sent_ = false;
+};
+
+template <typename T>
+struct _send_sender {
+  class type;
+};
+template <typename T>
+using send_sender = typename _send_sender<T>::type;
+
+template <typename T>
+class _send_sender<T>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  explicit type(channel<T>& c, T&& value)
+    : channel_(c), value_(std::move(value)) {}
+
+  template <typename Receiver>
+  send_operation<T, Receiver> connect(Receiver&& r) && {
+    return send_operation<T, Receiver>{
+        channel_, std::move(value_), (Receiver &&) r};
+  }
+
+ private:
+  channel<T>& channel_;
+  T value_;
+};
+
+template <typename T, typename Receiver>
+struct _next_op {
+  class type;
+};
+template <typename T, typename Receiver>
+using next_operation =
+    typename _next_op<T, std::remove_cvref_t<Receiver>>::type;
+
+template <typename T, typename Receiver>
+class _next_op<T, Receiver>::type final
+  : _waiter<type, Receiver>::type {
+  using base = typename _waiter<type, Receiver>::type;
+  friend base;
+
+ public:
+  template <typename Receiver2>
+  explicit type(channel<T>& c, Receiver2&& r)
+    : base(c.consumer_, (Receiver2 &&) r), channel_(c) {}
+
+  type(type&&) = delete;
+
+  using base::start;
+
+ private:
+  bool ready() noexcept {
+    if (!done_) {
+      // Read 'closed_' first: values sent before close() are then
+      // guaranteed to be visible to try_pop().
+      bool closed = channel_.closed_.load(std::memory_order_acquire);
+      done_ = channel_.try_pop(value_) || closed;
+    }
+    return done_;
+  }
+
+  static bool can_progress(const channel<T>& c) noexcept {
+    return c.head_.load(std::memory_order_relaxed) !=
+        c.tail_.load(std::memory_order_acquire) ||
+        c.closed_.load(std::memory_order_acquire);
+  }
+
+  void complete() noexcept {
+    if (value_.has_value()) {
+      unifex::set_value(std::move(this->receiver_), std::move(*value_));
+    } else {
+      unifex::set_done(std::move(this->receiver_));
+    }
+  }
+
+  channel<T>& channel_;
+  std::optional<T> value_;
+  bool done_ = false;
+};
+
+template <typename T>
+struct _next_sender {
+  class type;
+};
+template <typename T>
+using next_sender = typename _next_sender<T>::type;
+
+template <typename T>
+class _next_sender<T>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<T>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  explicit type(channel<T>& c) noexcept : channel_(c) {}
+
+  template <typename Receiver>
+  next_operation<T, Receiver> connect(Receiver&& r) && {
+    return next_operation<T, Receiver>{channel_, (Receiver &&) r};
+  }
+
+ private:
+  channel<T>& channel_;
+};
+
+template <typename T>
+struct _stream {
+  class type;
+};
+template <typename T>
+using stream = typename _stream<T>::type;
+
+template <typename T>
+class _stream<T>::type {
+ public:
+  explicit type(channel<T>& c) noexcept : channel_(&c) {}
+
+  friend next_sender<T> tag_invoke(tag_t<next>, type& s) noexcept {
+    return next_sender<T>{*s.channel_};
+  }
+
+  friend ready_done_sender tag_invoke(tag_t<cleanup>, type&) noexcept {
+    return {};
+  }
+
+ private:
+  channel<T>* channel_;
+};
+
+// A bounded single-producer, single-consumer channel.
+//
+// Values are passed through a lock-free ring buffer. A sender that finds
+// the buffer full, or a receiver that finds it empty, parks itself and is
+// resumed inline by the other side once it makes progress. A consumer that
+// is resumed keeps draining the buffer without suspending, so a burst of
+// values costs a single hand-off.
+template <typename T>
+class channel {
+  static_assert(
+      std::is_nothrow_move_constructible_v<T>,
+      "async_channel requires a nothrow move-constructible value type");
+
+  template <typename T2, typename Receiver>
+  friend struct _send_op;
+  template <typename T2, typename Receiver>
+  friend struct _next_op;
+
+ public:
+  // The capacity is rounded up to the next power of two.
+  explicit channel(std::size_t capacity)
+    : mask_(round_up_capacity(capacity) - 1),
+      slots_(new manual_lifetime<T>[mask_ + 1]) {}
+
+  channel(channel&&) = delete;
+
+  ~channel() {
+    assert(producer_.load(std::memory_order_relaxed) == nullptr);
+    assert(consumer_.load(std::memory_order_relaxed) == nullptr);
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    for (std::size_t i = head_.load(std::memory_order_relaxed); i != tail;
+         ++i) {
+      slots_[i & mask_].destruct();
+    }
+  }
+
+  // Returns a sender that completes once 'value' has been placed in the
+  // buffer, or with done if the channel has been closed.
+  //
+  // At most one send() operation may be outstanding at a time.
+  [[nodiscard]] send_sender<T> send(T value) {
+    return send_sender<T>{*this, std::move(value)};
+  }
+
+  // Ends the stream once the values already sent have been received.
+  void close() noexcept {
+    closed_.store(true, std::memory_order_release);
+    notify(consumer_);
+    notify(producer_);
+  }
+
+  // Returns a stream of the values sent to the channel.
+  //
+  // At most one next() operation may be outstanding at a time.
+  [[nodiscard]] _channel::stream<T> stream() noexcept {
+    return _channel::stream<T>{*this};
+  }
+
+ private:
+  static std::size_t round_up_capacity(std::size_t capacity) noexcept {
+    std::size_t result = 1;
+    while (result < capacity) {
+      result *= 2;
+    }
+    return result;
+  }
+
+  bool try_push(T& value) noexcept {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    slots_[tail & mask_].construct(std::move(value));
+    tail_.store(tail + 1, std::memory_order_release);
+    notify(consumer_);
+    return true;
+  }
+
+  bool try_pop(std::optional<T>& value) noexcept {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    auto& slot = slots_[head & mask_];
+    value.emplace(std::move(slot).get());
+    slot.destruct();
+    head_.store(head + 1, std::memory_order_release);
+    notify(producer_);
+    return true;
+  }
+
+  // Resumes the operation parked in 'slot', if any.
+  static void notify(std::atomic<waiter_base*>& slot) noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (slot.load(std::memory_order_relaxed) != nullptr) {
+      if (waiter_base* waiter =
+              slot.exchange(nullptr, std::memory_order_acq_rel)) {
+        waiter->resume_(waiter);
+      }
+    }
+  }
+
+  const std::size_t mask_;
+  const std::unique_ptr<manual_lifetime<T>[]> slots_;
+  // Written only by the consumer.
+  alignas(hardware_destructive_interference_size)
+      std::atomic<std::size_t> head_{0};
+  // Written only by the producer.
+  alignas(hardware_destructive_interference_size)
+      std::atomic<std::size_t> tail_{0};
+  alignas(hardware_destructive_interference_size)
+      std::atomic<bool> closed_{false};
+  std::atomic<waiter_base*> producer_{nullptr};
+  std::atomic<waiter_base*> consumer_{nullptr};
+};
+
+} // namespace _channel
+
+template <typename T>
+using async_channel = _channel::channel<T>;
+
+} // namespace unifex
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/async_trace.hpp>
+#include <unifex/coroutine.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/task.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/detail/error_variant.hpp>
+
+#if UNIFEX_NO_COROUTINES
+# error "C++20 coroutine support is required to use <unifex/async_generator.hpp>"
+#endif
+
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _agen {
+
+template <typename T, typename = void>
+inline constexpr bool is_sender_v = false;
+
+template <typename T>
+inline constexpr bool is_sender_v<
+    T,
+    std::void_t<typename T::template value_types<type_list, type_list>>> =
+    true;
+
+// The operation-state of the next() currently resuming the generator.
+template <typename Reference>
+struct consumer {
+  virtual void deliver_value(Reference value) noexcept = 0;
+  virtual void deliver_done() noexcept = 0;
+  virtual void deliver_error(std::exception_ptr ex) noexcept = 0;
+
+  // The stop-token passed on to senders awaited by the body.
+  virtual inplace_stop_token stop_token() noexcept = 0;
+};
+
+template <typename T>
+class async_generator;
+
+template <typename T>
+struct _promise {
+  struct type;
+};
+
+// Awaits a sender from the body of the generator, passing on the stop-token
+// of the next() that is currently resuming it.
+//
+// If the sender completes with set_done() then the generator is abandoned
+// at this point and the pending next() completes with set_done().
+template <typename Promise, typename Sender>
+struct _sender_awaiter {
+  struct type;
+};
+
+template <typename Promise, typename Sender>
+struct _sender_awaiter<Promise, Sender>::type {
+  using value_type = single_value_result_t<std::remove_cvref_t<Sender>>;
+  using error_variant =
+      detail::error_variant_t<std::remove_cvref_t<Sender>>;
+
+  struct receiver {
+    type& awaiter_;
+
+    template <typename... Values>
+    void set_value(Values&&... values) && noexcept {
+      try {
+        awaiter_.value_.construct((Values &&) values...);
+        awaiter_.state_ = state::value;
+      } catch (...) {
+        awaiter_.error_.construct(
+            std::in_place_type<std::exception_ptr>, std::current_exception());
+        awaiter_.state_ = state::error;
+      }
+      awaiter_.coro_.resume();
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      detail::store_error(awaiter_.error_, (Error &&) error);
+      awaiter_.state_ = state::error;
+      awaiter_.coro_.resume();
+    }
+
+    void set_done() && noexcept {
+      awaiter_.coro_.promise().abandon();
+    }
+
+    inplace_stop_token stop_token() const noexcept {
+      return awaiter_.coro_.promise().stop_token();
+    }
+
+    friend inplace_stop_token tag_invoke(
+        tag_t<get_stop_token>, const receiver& r) noexcept {
+      return r.stop_token();
+    }
+  };
+
+  explicit type(Sender&& sender)
+    : op_(connect((Sender &&) sender, receiver{*this})) {}
+
+  ~type() {
+    if (state_ == state::value) {
+      value_.destruct();
+    } else if (state_ == state::error) {
+      error_.destruct();
+    }
+  }
+
+  bool await_ready() noexcept {
+    return false;
+  }
+
+  void await_suspend(coro::coroutine_handle<Promise> h) noexcept {
+    coro_ = h;
+    start(op_);
+  }
+
+  value_type await_resume() {
+    if (state_ == state::error) {
+      detail::throw_error(std::move(error_).get());
+    }
+    return std::move(value_).get();
+  }
+
+ private:
+  enum class state { empty, value, error };
+
+  coro::coroutine_handle<Promise> coro_;
+  state state_ = state::empty;
+  union {
+    manual_lifetime<value_type> value_;
+    manual_lifetime<error_variant> error_;
+  };
+  operation_t<Sender, receiver> op_;
+};
+
+template <typename T>
+struct _promise<T>::type : _task::frame_allocation {
+  using reference = std::conditional_t<std::is_reference_v<T>, T, T&>;
+  using value_type = std::remove_reference_t<reference>;
+
+  struct yield_awaiter {
+    std::add_pointer_t<reference> value_;
+
+    bool await_ready() noexcept {
+      return false;
+    }
+
+    void await_suspend(coro::coroutine_handle<type> h) noexcept {
+      // The consumer may resume the generator from within deliver_value(),
+      // after which this awaiter must not be touched.
+      auto* c = std::exchange(h.promise().consumer_, nullptr);
+      c->deliver_value(static_cast<reference>(*value_));
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  struct final_awaiter {
+    bool await_ready() noexcept {
+      return false;
+    }
+
+    void await_suspend(coro::coroutine_handle<type> h) noexcept {
+      auto& p = h.promise();
+      auto* c = std::exchange(p.consumer_, nullptr);
+      if (p.exception_) {
+        c->deliver_error(std::move(p.exception_));
+      } else {
+        c->deliver_done();
+      }
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  async_generator<T> get_return_object() noexcept {
+    return async_generator<T>{
+        coro::coroutine_handle<type>::from_promise(*this)};
+  }
+
+  coro::suspend_always initial_suspend() noexcept {
+    return {};
+  }
+
+  final_awaiter final_suspend() noexcept {
+    return {};
+  }
+
+  void unhandled_exception() noexcept {
+    exception_ = std::current_exception();
+  }
+
+  void return_void() noexcept {}
+
+  // Yields a reference to the value, which stays alive until the consumer
+  // next calls next() or cleanup().
+  yield_awaiter yield_value(value_type& value) noexcept {
+    return yield_awaiter{std::addressof(value)};
+  }
+
+  yield_awaiter yield_value(value_type&& value) noexcept {
+    return yield_awaiter{std::addressof(value)};
+  }
+
+  template <typename Value>
+  decltype(auto) await_transform(Value&& value) {
+    if constexpr (is_sender_v<std::remove_cvref_t<Value>>) {
+      return typename _sender_awaiter<type, Value>::type{(Value &&) value};
+    } else {
+      return (Value &&) value;
+    }
+  }
+
+  // Completes the pending next() with set_done(). The generator is
+  // suspended for good and produces no more values.
+  void abandon() noexcept {
+    abandoned_ = true;
+    std::exchange(consumer_, nullptr)->deliver_done();
+  }
+
+  inplace_stop_token stop_token() const noexcept {
+    return consumer_->stop_token();
+  }
+
+  consumer<reference>* consumer_ = nullptr;
+  std::exception_ptr exception_;
+  bool abandoned_ = false;
+};
+
+template <typename T, typename Receiver>
+struct _next_op {
+  struct type;
+};
+
+template <typename T, typename Receiver>
+struct _next_op<T, Receiver>::type final
+  : consumer<typename _promise<T>::type::reference> {
+  using promise_type = typename _promise<T>::type;
+  using reference = typename promise_type::reference;
+  using stop_token_type = stop_token_type_t<Receiver&>;
+
+  // A stop-token other than inplace_stop_token is adapted to one.
+  static constexpr bool adapt_stop_token =
+      !std::is_same_v<stop_token_type, inplace_stop_token> &&
+      !is_stop_never_possible_v<stop_token_type>;
+
+  struct cancel_callback {
+    inplace_stop_source& stopSource_;
+
+    void operator()() noexcept {
+      stopSource_.request_stop();
+    }
+  };
+
+  struct empty {};
+
+  template <typename Receiver2>
+  explicit type(coro::coroutine_handle<promise_type> coro, Receiver2&& r)
+    : coro_(coro), receiver_((Receiver2 &&) r) {}
+
+  void start() noexcept {
+    if (!coro_ || coro_.done() || coro_.promise().abandoned_ ||
+        get_stop_token(receiver_).stop_requested()) {
+      unifex::set_done(std::move(receiver_));
+      return;
+    }
+
+    if constexpr (adapt_stop_token) {
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{stopSource_});
+    }
+
+    coro_.promise().consumer_ = this;
+    coro_.resume();
+  }
+
+  void deliver_value(reference value) noexcept final {
+    reset_stop_callback();
+    try {
+      unifex::set_value(std::move(receiver_), static_cast<reference>(value));
+    } catch (...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+    }
+  }
+
+  void deliver_done() noexcept final {
+    reset_stop_callback();
+    unifex::set_done(std::move(receiver_));
+  }
+
+  void deliver_error(std::exception_ptr ex) noexcept final {
+    reset_stop_callback();
+    unifex::set_error(std::move(receiver_), std::move(ex));
+  }
+
+  inplace_stop_token stop_token() noexcept final {
+    if constexpr (adapt_stop_token) {
+      return stopSource_.get_token();
+    } else if constexpr (std::is_same_v<stop_token_type, inplace_stop_token>) {
+      return get_stop_token(receiver_);
+    } else {
+      return {};
+    }
+  }
+
+  template <typename Func>
+  friend void
+  tag_invoke(tag_t<visit_continuations>, const type& op, Func&& func) {
+    std::invoke(func, op.receiver_);
+  }
+
+ private:
+  void reset_stop_callback() noexcept {
+    if constexpr (adapt_stop_token) {
+      stopCallback_.destruct();
+    }
+  }
+
+  coro::coroutine_handle<promise_type> coro_;
+  Receiver receiver_;
+  UNIFEX_NO_UNIQUE_ADDRESS
+      std::conditional_t<adapt_stop_token, inplace_stop_source, empty>
+          stopSource_;
+  UNIFEX_NO_UNIQUE_ADDRESS std::conditional_t<
+      adapt_stop_token,
+      manual_lifetime<typename stop_token_type::template callback_type<
+          cancel_callback>>,
+      empty>
+      stopCallback_;
+};
+
+template <typename T>
+struct next_sender {
+  using promise_type = typename _promise<T>::type;
+
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<typename promise_type::reference>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  template <typename Receiver>
+  auto connect(Receiver&& r) && {
+    return typename _next_op<T, std::remove_cvref_t<Receiver>>::type{
+        coro_, (Receiver &&) r};
+  }
+
+  coro::coroutine_handle<promise_type> coro_;
+};
+
+template <typename Receiver>
+struct _cleanup_op {
+  struct type;
+};
+
+// Destroys the coroutine frame, including any locals of a body that did not
+// run to completion, and then completes with set_done().
+template <typename Receiver>
+struct _cleanup_op<Receiver>::type {
+  coro::coroutine_handle<> coro_;
+  UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+
+  void start() noexcept {
+    if (coro_) {
+      coro_.destroy();
+    }
+    unifex::set_done(std::move(receiver_));
+  }
+};
+
+template <typename T>
+struct cleanup_sender {
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  template <typename Receiver>
+  auto connect(Receiver&& r) && {
+    return typename _cleanup_op<std::remove_cvref_t<Receiver>>::type{
+        std::exchange(generator_.coro_, {}), (Receiver &&) r};
+  }
+
+  async_generator<T>& generator_;
+};
+
+// A coroutine that models a stream.
+//
+// The body starts on the first call to next() and runs until it yields a
+// value, which is passed to the consumer by reference, or until it returns.
+// Senders awaited by the body are passed the stop-token of the consumer's
+// next() and if one completes with set_done() then so does next().
+//
+// Frames are allocated in the same way as for task<T>.
+template <typename T>
+class async_generator {
+ public:
+  using promise_type = typename _promise<T>::type;
+
+  async_generator(async_generator&& other) noexcept
+    : coro_(std::exchange(other.coro_, {})) {}
+
+  ~async_generator() {
+    if (coro_) {
+      coro_.destroy();
+    }
+  }
+
+  friend next_sender<T> tag_invoke(tag_t<next>, async_generator& g) noexcept {
+    return next_sender<T>{g.coro_};
+  }
+
+  friend cleanup_sender<T>
+  tag_invoke(tag_t<cleanup>, async_generator& g) noexcept {
+    return cleanup_sender<T>{g};
+  }
+
+ private:
+  friend promise_type;
+  friend cleanup_sender<T>;
+
+  explicit async_generator(coro::coroutine_handle<promise_type> coro) noexcept
+    : coro_(coro) {}
+
+  coro::coroutine_handle<promise_type> coro_;
+};
+
+} // namespace _agen
+
+using _agen::async_generator;
+
+} // namespace unifex
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/async_manual_reset_event.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace unifex {
+
+// A single-use counter that operations can wait on asynchronously until it
+// has been counted down to zero.
+class async_latch {
+public:
+  explicit async_latch(std::ptrdiff_t expected) noexcept
+    : counter_(expected), event_(expected <= 0) {}
+
+  // Decrement the counter by 'n', completing waiting operations if it
+  // reaches zero.
+  void count_down(std::ptrdiff_t n = 1) noexcept {
+    if (counter_.fetch_sub(n, std::memory_order_acq_rel) == n) {
+      event_.set();
+    }
+  }
+
+  [[nodiscard]] bool try_wait() const noexcept { return event_.ready(); }
+
+  [[nodiscard]] auto async_wait() noexcept { return event_.async_wait(); }
+
+  template <typename Scheduler>
+  [[nodiscard]] auto async_wait_on(Scheduler &&scheduler) noexcept(
+      std::is_nothrow_constructible_v<
+          std::remove_cvref_t<Scheduler>, Scheduler>) {
+    return event_.async_wait_on((Scheduler &&) scheduler);
+  }
+
+private:
+  std::atomic<std::ptrdiff_t> counter_;
+  async_manual_reset_event event_;
+};
+
+} // namespace unifex
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/detail/async_waiter.hpp>
+
+#include <atomic>
+#include <type_traits>
+
+namespace unifex {
+
+// An event that can be waited on asynchronously. Once set() is called all
+// waiting operations complete, as do any operations started before the next
+// call to reset().
+class async_manual_reset_event {
+public:
+  explicit async_manual_reset_event(bool startSignalled = false) noexcept;
+  async_manual_reset_event(const async_manual_reset_event &) = delete;
+  async_manual_reset_event(async_manual_reset_event &&) = delete;
+  ~async_manual_reset_event();
+
+  async_manual_reset_event &
+  operator=(const async_manual_reset_event &) = delete;
+  async_manual_reset_event &operator=(async_manual_reset_event &&) = delete;
+
+  [[nodiscard]] bool ready() const noexcept;
+
+  // Set the event, completing all waiting operations.
+  void set() noexcept;
+
+  // Reset the event if it is set. Has no effect otherwise.
+  void reset() noexcept;
+
+  // Returns a sender that completes with set_value() once the event is set.
+  // Waiters are resumed inline inside the call to set().
+  [[nodiscard]] _async_wait::sender<void> async_wait() noexcept;
+
+  // As async_wait() but if the operation has to wait then it is resumed by
+  // scheduling onto 'scheduler'.
+  template <typename Scheduler>
+  [[nodiscard]] _async_wait::sender<std::remove_cvref_t<Scheduler>>
+  async_wait_on(Scheduler &&scheduler) noexcept(
+      std::is_nothrow_constructible_v<
+          std::remove_cvref_t<Scheduler>, Scheduler>);
+
+private:
+  static bool try_enqueue(void *self, _async_wait::waiter_base *waiter) noexcept;
+
+  void *signalled_value() const noexcept {
+    return const_cast<void *>(static_cast<const void *>(this));
+  }
+
+  // Either signalled_value() if set, or the top of the stack of waiters.
+  std::atomic<void *> state_;
+};
+
+inline bool async_manual_reset_event::ready() const noexcept {
+  return state_.load(std::memory_order_acquire) == signalled_value();
+}
+
+inline _async_wait::sender<void>
+async_manual_reset_event::async_wait() noexcept {
+  return _async_wait::sender<void>{
+      this, &async_manual_reset_event::try_enqueue, _async_wait::empty{}};
+}
+
+template <typename Scheduler>
+inline _async_wait::sender<std::remove_cvref_t<Scheduler>>
+async_manual_reset_event::async_wait_on(Scheduler &&scheduler) noexcept(
+    std::is_nothrow_constructible_v<std::remove_cvref_t<Scheduler>,
+                                    Scheduler>) {
+  return _async_wait::sender<std::remove_cvref_t<Scheduler>>{
+      this, &async_manual_reset_event::try_enqueue, (Scheduler &&) scheduler};
+}
+
+} // namespace unifex
@@ -0,0 +1,327 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/detail/async_waiter.hpp>
+#include <unifex/detail/atomic_intrusive_queue.hpp>
+#include <unifex/detail/intrusive_queue.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/type_list.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+
+// A counting semaphore whose permits can be acquired asynchronously.
+//
+// Waiters are pushed to an atomic_intrusive_queue that any thread can push
+// to, and drained into a pending queue by whichever thread currently holds
+// the queue's 'active' state. That thread hands permits to pending waiters
+// in FIFO order, reserving them for the waiter at the front of the queue as
+// they are released so a large request cannot be starved by smaller ones,
+// and removes waiters whose stop-token has been triggered.
+//
+// Permits released while there are waiters are handed to that thread rather
+// than made available, so that try_acquire() and newly started operations
+// cannot take them ahead of the queued waiters.
+class async_semaphore {
+  // Scheduler is void if waiters are resumed inline on the thread that
+  // made the permits available.
+  template <typename Scheduler>
+  class acquire_sender;
+
+public:
+  explicit async_semaphore(std::ptrdiff_t initialPermits) noexcept;
+  async_semaphore(const async_semaphore &) = delete;
+  async_semaphore(async_semaphore &&) = delete;
+  ~async_semaphore();
+
+  async_semaphore &operator=(const async_semaphore &) = delete;
+  async_semaphore &operator=(async_semaphore &&) = delete;
+
+  // Attempt to acquire 'count' permits synchronously.
+  // Note that this may succeed even if there are queued waiters.
+  [[nodiscard]] bool try_acquire(std::ptrdiff_t count = 1) noexcept;
+
+  // Returns a sender that completes with set_value() once 'count' permits
+  // have been acquired, or with set_done() if stop is requested first.
+  [[nodiscard]] acquire_sender<void>
+  async_acquire(std::ptrdiff_t count = 1) noexcept;
+
+  // As async_acquire() but if the operation has to wait then it is resumed
+  // by scheduling onto 'scheduler' rather than inline on the thread that
+  // released the permits.
+  template <typename Scheduler>
+  [[nodiscard]] acquire_sender<std::remove_cvref_t<Scheduler>>
+  async_acquire_on(Scheduler &&scheduler, std::ptrdiff_t count = 1) noexcept(
+      std::is_nothrow_constructible_v<
+          std::remove_cvref_t<Scheduler>, Scheduler>);
+
+  // Return 'count' permits to the semaphore, completing any waiters that
+  // can now proceed.
+  void release(std::ptrdiff_t count = 1) noexcept;
+
+private:
+  struct waiter_base {
+    void (*resume_)(waiter_base *) noexcept;
+    waiter_base *next_;
+    // Permits still needed and permits already reserved for this waiter.
+    // Only accessed by the thread processing the queue.
+    std::ptrdiff_t remaining_;
+    std::ptrdiff_t reserved_ = 0;
+    bool acquired_ = false;
+    std::atomic<bool> stopRequested_{false};
+  };
+
+  using empty = _async_wait::empty;
+
+  template <typename Scheduler>
+  class acquire_sender {
+    static constexpr bool resume_inline = std::is_void_v<Scheduler>;
+
+    using scheduler_type = std::conditional_t<resume_inline, empty, Scheduler>;
+
+  public:
+    template <template <typename...> class Variant,
+              template <typename...> class Tuple>
+    using value_types = Variant<Tuple<>>;
+
+    template <template <typename...> class Variant>
+    using error_types =
+        typename _async_wait::_errors<Scheduler>::type::template apply<Variant>;
+
+    acquire_sender(const acquire_sender &) = delete;
+    acquire_sender(acquire_sender &&) = default;
+
+  private:
+    friend async_semaphore;
+
+    template <typename Scheduler2>
+    explicit acquire_sender(async_semaphore &semaphore,
+                            std::ptrdiff_t count,
+                            Scheduler2 &&scheduler) noexcept(
+        std::is_nothrow_constructible_v<scheduler_type, Scheduler2>)
+      : semaphore_(semaphore),
+        count_(count),
+        scheduler_((Scheduler2 &&) scheduler) {}
+
+    template <typename Receiver>
+    struct _op {
+      class type
+        : waiter_base,
+          _async_wait::
+              resumable<type, Scheduler, stop_token_type_t<Receiver &>> {
+        using stop_token_type = stop_token_type_t<Receiver &>;
+        using base =
+            _async_wait::resumable<type, Scheduler, stop_token_type>;
+        friend base;
+
+        static constexpr bool stop_possible =
+            !is_stop_never_possible_v<stop_token_type>;
+
+        struct cancel_callback {
+          type &op_;
+
+          void operator()() noexcept {
+            op_.semaphore_.request_stop(&op_);
+          }
+        };
+
+      public:
+        template <typename Receiver2>
+        explicit type(async_semaphore &semaphore, std::ptrdiff_t count,
+                      scheduler_type &&scheduler, Receiver2 &&r) noexcept
+            : semaphore_(semaphore),
+              scheduler_(std::move(scheduler)),
+              receiver_(std::move(r)) {
+          this->remaining_ = count;
+          this->resume_ = [](waiter_base * self) noexcept {
+            type &op = *static_cast<type *>(self);
+            if constexpr (stop_possible) {
+              op.stopCallback_.destruct();
+            }
+            if (!op.acquired_) {
+              unifex::set_done(std::move(op.receiver_));
+            } else if constexpr (resume_inline) {
+              unifex::set_value(std::move(op.receiver_));
+            } else {
+              op.resume_on_scheduler();
+            }
+          };
+        }
+
+        type(type &&) = delete;
+
+        friend void tag_invoke(tag_t<start>, type &op) noexcept {
+          op.start();
+        }
+
+      private:
+        void start() noexcept {
+          if (semaphore_.try_acquire(this->remaining_)) {
+            // Acquired synchronously. Invoke the continuation inline
+            // without type-erasure here.
+            unifex::set_value(std::move(receiver_));
+            return;
+          }
+          if constexpr (stop_possible) {
+            auto stopToken = get_stop_token(receiver_);
+            if (stopToken.stop_requested()) {
+              unifex::set_done(std::move(receiver_));
+              return;
+            }
+            // If stop is requested from here on the waiter is removed
+            // from the queue by whichever thread processes it next.
+            stopCallback_.construct(
+                stop_token_type{std::move(stopToken)}, cancel_callback{*this});
+          }
+          semaphore_.enqueue(this);
+        }
+
+        // The permits have been acquired but the operation is completing
+        // with an error or done after all, so release them again.
+        void resume_failed() noexcept {
+          semaphore_.release(this->reserved_);
+        }
+
+        stop_token_type resume_stop_token() const noexcept {
+          return get_stop_token(receiver_);
+        }
+
+        async_semaphore &semaphore_;
+        UNIFEX_NO_UNIQUE_ADDRESS scheduler_type scheduler_;
+        Receiver receiver_;
+        UNIFEX_NO_UNIQUE_ADDRESS std::conditional_t<
+            stop_possible,
+            manual_lifetime<typename stop_token_type::template callback_type<
+                cancel_callback>>,
+            empty>
+            stopCallback_;
+      };
+    };
+    template <typename Receiver>
+    using operation = typename _op<std::remove_cvref_t<Receiver>>::type;
+
+    template <typename Receiver>
+    friend operation<Receiver>
+    tag_invoke(tag_t<connect>, acquire_sender &&s, Receiver &&r) noexcept {
+      return operation<Receiver>{
+          s.semaphore_, s.count_, std::move(s.scheduler_), std::move(r)};
+    }
+
+    async_semaphore &semaphore_;
+    std::ptrdiff_t count_;
+    UNIFEX_NO_UNIQUE_ADDRESS scheduler_type scheduler_;
+  };
+
+  using waiter_queue = intrusive_queue<waiter_base, &waiter_base::next_>;
+
+  // Called by release() when there may be waiters to hand the permits to.
+  void release_to_waiters() noexcept;
+
+  // Called by release() to hand 'count' permits to the queued waiters.
+  void hand_off(std::ptrdiff_t count) noexcept;
+
+  // Add the waiter to the queue, processing it if no other thread is.
+  void enqueue(waiter_base *waiter) noexcept;
+
+  // Called from a waiter's stop-callback.
+  void request_stop(waiter_base *waiter) noexcept;
+
+  // Called by a thread that has marked 'atomicQueue_' as active. Hands out
+  // permits and removes stopped waiters until there is nothing left to do,
+  // then marks the queue inactive and completes the waiters it removed.
+  void process() noexcept;
+
+  void add_pending(waiter_queue waiters, waiter_queue &completed) noexcept;
+  void remove_stopped(
+      waiter_queue &completed, std::ptrdiff_t &handedOff) noexcept;
+  void grant_pending(
+      waiter_queue &completed, std::ptrdiff_t &handedOff) noexcept;
+
+  // Takes up to 'count' available permits, returning the number taken.
+  std::ptrdiff_t reserve(std::ptrdiff_t count) noexcept;
+
+  const std::ptrdiff_t initialPermits_;
+  std::atomic<std::ptrdiff_t> available_;
+  // Number of waiters that have been enqueued and not yet completed.
+  std::atomic<std::size_t> waiterCount_{0};
+  // Permits released while there were waiters, which only the thread
+  // processing the queue may take.
+  std::atomic<std::ptrdiff_t> handedOff_{0};
+  std::atomic<std::size_t> stopRequestCount_{0};
+  atomic_intrusive_queue<waiter_base, &waiter_base::next_> atomicQueue_;
+  waiter_queue pendingQueue_;
+};
+
+inline async_semaphore::acquire_sender<void>
+async_semaphore::async_acquire(std::ptrdiff_t count) noexcept {
+  return acquire_sender<void>{*this, count, empty{}};
+}
+
+template <typename Scheduler>
+inline async_semaphore::acquire_sender<std::remove_cvref_t<Scheduler>>
+async_semaphore::async_acquire_on(
+    Scheduler &&scheduler, std::ptrdiff_t count) noexcept(
+    std::is_nothrow_constructible_v<
+        std::remove_cvref_t<Scheduler>, Scheduler>) {
+  return acquire_sender<std::remove_cvref_t<Scheduler>>{
+      *this, count, (Scheduler &&) scheduler};
+}
+
+inline bool async_semaphore::try_acquire(std::ptrdiff_t count) noexcept {
+  // Start by assuming that none of the permits are in use, which is the
+  // uncontended case (eg. for an async_mutex), so that acquiring them takes
+  // a single CAS. A failed CAS loads the actual count for the next attempt.
+  std::ptrdiff_t available = initialPermits_;
+  if (available < count) {
+    available = available_.load(std::memory_order_relaxed);
+  }
+  while (available >= count) {
+    if (available_.compare_exchange_weak(
+            available, available - count, std::memory_order_acquire,
+            std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void async_semaphore::release(std::ptrdiff_t count) noexcept {
+  if (waiterCount_.load(std::memory_order_seq_cst) != 0) {
+    hand_off(count);
+    return;
+  }
+  available_.fetch_add(count, std::memory_order_seq_cst);
+  // Pairs with the increment in enqueue(): either the waiter sees these
+  // permits or we see the waiter.
+  if (waiterCount_.load(std::memory_order_seq_cst) != 0) {
+    release_to_waiters();
+  }
+}
+
+} // namespace unifex
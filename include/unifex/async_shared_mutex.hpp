@@ -0,0 +1,77 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/async_semaphore.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace unifex {
+
+// A reader-writer mutex that allows acquiring either shared or exclusive
+// ownership asynchronously.
+//
+// Implemented as an async_semaphore where each reader holds one permit and
+// a writer holds all of them. Pending lock requests are granted in FIFO
+// order, so a waiting writer is not starved by a stream of new readers.
+class async_shared_mutex {
+public:
+  async_shared_mutex() noexcept : semaphore_(max_readers) {}
+
+  [[nodiscard]] bool try_lock() noexcept {
+    return semaphore_.try_acquire(max_readers);
+  }
+
+  [[nodiscard]] auto async_lock() noexcept {
+    return semaphore_.async_acquire(max_readers);
+  }
+
+  template <typename Scheduler>
+  [[nodiscard]] auto async_lock_on(Scheduler &&scheduler) noexcept(
+      std::is_nothrow_constructible_v<
+          std::remove_cvref_t<Scheduler>, Scheduler>) {
+    return semaphore_.async_acquire_on((Scheduler &&) scheduler, max_readers);
+  }
+
+  void unlock() noexcept { semaphore_.release(max_readers); }
+
+  [[nodiscard]] bool try_lock_shared() noexcept {
+    return semaphore_.try_acquire(1);
+  }
+
+  [[nodiscard]] auto async_lock_shared() noexcept {
+    return semaphore_.async_acquire(1);
+  }
+
+  template <typename Scheduler>
+  [[nodiscard]] auto async_lock_shared_on(Scheduler &&scheduler) noexcept(
+      std::is_nothrow_constructible_v<
+          std::remove_cvref_t<Scheduler>, Scheduler>) {
+    return semaphore_.async_acquire_on((Scheduler &&) scheduler, 1);
+  }
+
+  void unlock_shared() noexcept { semaphore_.release(1); }
+
+private:
+  static constexpr std::ptrdiff_t max_readers =
+      std::numeric_limits<std::ptrdiff_t>::max();
+
+  async_semaphore semaphore_;
+};
+
+} // namespace unifex
@@ -22,6 +22,7 @@
 #include <unifex/config.hpp>
 #include <unifex/coroutine.hpp>
 
+#include <exception>
 #include <functional>
 #include <typeindex>
 #include <vector>
@@ -38,6 +38,11 @@ struct sender_task {
     explicit promise_type(Awaitable&, Receiver& r) noexcept
         : info_(continuation_info::from_continuation(r)) {}
 
+    // Some compilers also pass the lambda object to the promise.
+    template <typename Lambda, typename Awaitable, typename Receiver>
+    explicit promise_type(Lambda&, Awaitable&, Receiver& r) noexcept
+        : info_(continuation_info::from_continuation(r)) {}
+
     sender_task get_return_object() noexcept {
       return sender_task{
           coro::coroutine_handle<promise_type>::from_promise(
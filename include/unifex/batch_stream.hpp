@@ -0,0 +1,379 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/span.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/buffered_stream.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace unifex {
+namespace _batch {
+
+using clock_t = std::chrono::steady_clock;
+
+using _buffered::waiter_base;
+
+template <typename Stream, typename Scheduler>
+struct _state {
+  class type;
+};
+template <typename Stream, typename Scheduler>
+using state = typename _state<Stream, Scheduler>::type;
+
+template <typename Stream, typename Scheduler>
+struct _timer_receiver {
+  class type;
+};
+template <typename Stream, typename Scheduler>
+using timer_receiver = typename _timer_receiver<Stream, Scheduler>::type;
+
+template <typename Stream, typename Scheduler>
+class _timer_receiver<Stream, Scheduler>::type {
+ public:
+  explicit type(state<Stream, Scheduler>& s) noexcept : state_(s) {}
+
+  void set_value() && noexcept {
+    state_.timer_fired();
+  }
+
+  // A timer that fails or is cancelled simply flushes the current batch
+  // early; the batch size bound still holds.
+  template <typename Error>
+  void set_error(Error&&) && noexcept {
+    state_.timer_fired();
+  }
+
+  void set_done() && noexcept {
+    state_.timer_fired();
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_token();
+  }
+
+ private:
+  state<Stream, Scheduler>& state_;
+};
+
+// The state shared by the batching stream and its operations.
+//
+// Values from the source stream are appended to 'filling_' until it holds
+// 'maxCount_' values or the oldest of them has waited 'maxDelay_', at which
+// point the batch is handed to the consumer by swapping it with 'emitted_'.
+// The two buffers are reused for the lifetime of the stream so that, once
+// warmed up, producing a batch does not allocate.
+//
+// A single timer is kept running while there are buffered values. When it
+// fires for a batch that has already been emitted it is re-armed for the
+// remaining time of the current batch rather than being cancelled.
+template <typename Stream, typename Scheduler>
+class _state<Stream, Scheduler>::type
+  : public _buffered::state_base<type, Stream> {
+  using base = _buffered::state_base<type, Stream>;
+  friend base;
+  template <typename State>
+  friend struct _buffered::_fetch_receiver;
+  template <typename Stream2, typename Scheduler2>
+  friend struct _timer_receiver;
+
+  using base::consumer_;
+  using base::fetching_;
+  using base::mutex_;
+  using base::stopping_;
+
+ public:
+  using element_type = std::remove_cvref_t<
+      typename next_sender_t<Stream>::template value_types<
+          single_type_t,
+          single_type_t>>;
+  using value_type = span<element_type>;
+
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<value_type>>;
+
+  template <typename Stream2, typename Scheduler2>
+  explicit type(
+      Stream2&& stream,
+      std::size_t maxCount,
+      clock_t::duration maxDelay,
+      Scheduler2&& scheduler)
+    : base((Stream2 &&) stream),
+      scheduler_((Scheduler2 &&) scheduler),
+      maxCount_(maxCount),
+      maxDelay_(maxDelay) {
+    assert(maxCount > 0);
+    filling_.reserve(maxCount);
+    emitted_.reserve(maxCount);
+  }
+
+  ~type() {
+    assert(!timerRunning_);
+  }
+
+  // Tries to take the next batch for the consumer, releasing the batch
+  // previously returned.
+  //
+  // If no batch is ready yet then 'waiter' is parked until one is and
+  // 'false' is returned. Otherwise, either 'batch' is filled in or, at the
+  // end of the stream, 'error' is set if the source stream failed, and
+  // 'true' is returned.
+  bool try_take(
+      waiter_base* waiter,
+      std::optional<value_type>& batch,
+      std::exception_ptr& error) noexcept {
+    std::unique_lock lock{mutex_};
+    emitted_.clear();
+    bool result = true;
+    if (batch_ready()) {
+      std::swap(filling_, emitted_);
+      timedOut_ = false;
+      batch.emplace(emitted_.data(), emitted_.size());
+    } else if (filling_.empty() && sourceDone_) {
+      error = std::exchange(error_, nullptr);
+    } else {
+      consumer_ = waiter;
+      result = false;
+    }
+    bool shouldFetch = start_fetching();
+    lock.unlock();
+
+    if (shouldFetch) {
+      this->fetch();
+    }
+    return result;
+  }
+
+  template <typename Receiver>
+  static void deliver_value(Receiver&& receiver, value_type&& batch) noexcept {
+    unifex::set_value((Receiver &&) receiver, batch);
+  }
+
+ private:
+  using timer_op_t = operation_t<
+      callable_result_t<
+          tag_t<schedule_after>,
+          Scheduler&,
+          const clock_t::duration&>,
+      timer_receiver<Stream, Scheduler>>;
+
+  // Must be called with the mutex held.
+  bool batch_ready() const noexcept {
+    return filling_.size() >= maxCount_ ||
+        (!filling_.empty() && (timedOut_ || sourceDone_));
+  }
+
+  // Must be called with the mutex held.
+  bool start_fetching() noexcept {
+    if (fetching_ || stopping_ || sourceDone_ ||
+        filling_.size() >= maxCount_) {
+      return false;
+    }
+    fetching_ = true;
+    return true;
+  }
+
+  // Must be called with the mutex held.
+  void discard() noexcept {
+    filling_.clear();
+    emitted_.clear();
+  }
+
+  // Must be called with the mutex held.
+  bool in_flight() const noexcept {
+    return fetching_ || timerRunning_;
+  }
+
+  void start_timer(clock_t::duration delay) noexcept {
+    try {
+      timerOp_.construct_from([&] {
+        return unifex::connect(
+            schedule_after(scheduler_, std::as_const(delay)),
+            timer_receiver<Stream, Scheduler>{*this});
+      });
+    } catch (...) {
+      timer_fired_early();
+      return;
+    }
+    unifex::start(timerOp_.get());
+  }
+
+  template <typename Value>
+  void fetch_value(Value&& value) noexcept {
+    std::unique_lock lock{mutex_};
+    if (stopping_) {
+      lock.unlock();
+      this->destroy_fetch();
+      lock.lock();
+      fetching_ = false;
+      this->stopped(std::move(lock));
+      return;
+    }
+
+    fetching_ = false;
+    try {
+      filling_.emplace_back((Value &&) value);
+    } catch (...) {
+      sourceDone_ = true;
+      error_ = std::current_exception();
+    }
+    this->destroy_fetch();
+
+    bool shouldStartTimer = false;
+    if (filling_.size() == 1) {
+      deadline_ = clock_t::now() + maxDelay_;
+      shouldStartTimer = !std::exchange(timerRunning_, true);
+    }
+    finish(std::move(lock), shouldStartTimer, maxDelay_);
+  }
+
+  void end_fetch(std::exception_ptr error) noexcept {
+    std::unique_lock lock{mutex_};
+    fetching_ = false;
+    if (stopping_) {
+      this->stopped(std::move(lock));
+      return;
+    }
+    sourceDone_ = true;
+    error_ = std::move(error);
+    finish(std::move(lock), false, {});
+  }
+
+  void timer_fired() noexcept {
+    timerOp_.destruct();
+    std::unique_lock lock{mutex_};
+    timerRunning_ = false;
+    if (stopping_) {
+      this->stopped(std::move(lock));
+      return;
+    }
+    if (filling_.empty()) {
+      // The timer will be restarted by the next value fetched.
+      return;
+    }
+
+    bool shouldStartTimer = false;
+    clock_t::duration remaining = deadline_ - clock_t::now();
+    if (remaining <= clock_t::duration::zero()) {
+      timedOut_ = true;
+    } else {
+      // The batch this timer was started for has already been emitted.
+      timerRunning_ = shouldStartTimer = true;
+    }
+    finish(std::move(lock), shouldStartTimer, remaining);
+  }
+
+  void timer_fired_early() noexcept {
+    std::unique_lock lock{mutex_};
+    timerRunning_ = false;
+    if (stopping_) {
+      this->stopped(std::move(lock));
+      return;
+    }
+    timedOut_ = true;
+    finish(std::move(lock), false, {});
+  }
+
+  // Wakes the consumer if a batch is ready and restarts any operations
+  // that should now be running, releasing 'lock' first.
+  void finish(
+      std::unique_lock<std::mutex> lock,
+      bool shouldStartTimer,
+      clock_t::duration delay) noexcept {
+    waiter_base* consumer = nullptr;
+    if (batch_ready() || (filling_.empty() && sourceDone_)) {
+      consumer = std::exchange(consumer_, nullptr);
+    }
+    bool shouldFetch = start_fetching();
+    lock.unlock();
+
+    if (shouldStartTimer) {
+      start_timer(delay);
+    }
+    if (shouldFetch) {
+      this->fetch();
+    }
+    this->resume(consumer);
+  }
+
+  Scheduler scheduler_;
+  const std::size_t maxCount_;
+  const clock_t::duration maxDelay_;
+  std::vector<element_type> filling_;
+  std::vector<element_type> emitted_;
+  clock_t::time_point deadline_;
+  bool timerRunning_ = false;
+  bool timedOut_ = false;
+  bool sourceDone_ = false;
+  std::exception_ptr error_;
+  manual_lifetime<timer_op_t> timerOp_;
+};
+
+template <typename Stream, typename Scheduler>
+using stream = _buffered::stream<
+    state<std::remove_cvref_t<Stream>, std::remove_cvref_t<Scheduler>>>;
+
+} // namespace _batch
+
+namespace _batch_cpo {
+  inline constexpr struct _fn {
+    template <
+        typename Stream,
+        typename Rep,
+        typename Ratio,
+        typename TimeScheduler>
+    _batch::stream<Stream, TimeScheduler> operator()(
+        Stream&& stream,
+        std::size_t maxCount,
+        std::chrono::duration<Rep, Ratio> maxDelay,
+        TimeScheduler&& scheduler) const {
+      using state_t = _batch::state<
+          std::remove_cvref_t<Stream>,
+          std::remove_cvref_t<TimeScheduler>>;
+      return _batch::stream<Stream, TimeScheduler>{std::make_unique<state_t>(
+          (Stream &&) stream,
+          maxCount,
+          std::chrono::ceil<_batch::clock_t::duration>(maxDelay),
+          (TimeScheduler &&) scheduler)};
+    }
+  } batch_stream{};
+} // namespace _batch_cpo
+
+using _batch_cpo::batch_stream;
+
+} // namespace unifex
@@ -110,12 +110,21 @@ namespace _demat {
     template <typename... Values>
     struct apply_impl;
 
+    // Only form Tuple<Rest...> for matching completions, as Tuple may not
+    // accept the arguments of the others (eg. single_type_t of set_done()).
+    template <bool Matches, typename... Rest>
+    struct select {
+      using type = type_list<>;
+    };
+
+    template <typename... Rest>
+    struct select<true, Rest...> {
+      using type = type_list<Tuple<Rest...>>;
+    };
+
     template <typename First, typename... Rest>
     struct apply_impl<First, Rest...>
-      : std::conditional<
-            std::is_base_of_v<CPO, std::decay_t<First>>,
-            type_list<Tuple<Rest...>>,
-            type_list<>> {};
+      : select<std::is_base_of_v<CPO, std::decay_t<First>>, Rest...> {};
 
    public:
     template <typename... Values>
@@ -146,7 +155,7 @@ namespace _demat {
         // Concatenate and deduplicate errors from value_types, error_types along with
         // std::exception_ptr.
         template <typename... OtherErrors>
-        using apply = typename concat_type_lists_unique<
+        using apply = typename concat_type_lists_unique_t<
             type_list<Errors...>,
             type_list<OtherErrors...>,
             type_list<std::exception_ptr>>::template apply<Variant>;
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/unstoppable_token.hpp>
+
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _async_wait {
+
+// An operation waiting to be released by an async_manual_reset_event,
+// async_latch or async_barrier.
+//
+// Waiters are pushed onto an intrusive lock-free stack with a single CAS
+// and the whole stack is detached with one exchange when the waiters are
+// released.
+struct waiter_base {
+  void (*resume_)(waiter_base *) noexcept;
+  waiter_base *next_;
+};
+
+// Resume a stack of waiters detached from a waiter list, in the order that
+// they were pushed.
+inline void resume_all(waiter_base *stack) noexcept {
+  waiter_base *list = nullptr;
+  while (stack != nullptr) {
+    waiter_base *next = stack->next_;
+    stack->next_ = list;
+    list = stack;
+    stack = next;
+  }
+  while (list != nullptr) {
+    // Read next_ first as resume_() may destroy the waiter.
+    waiter_base *next = list->next_;
+    list->resume_(list);
+    list = next;
+  }
+}
+
+// Either enqueues the waiter and returns true, or returns false if the wait
+// is already satisfied and the waiter should complete inline.
+using enqueue_fn = bool(void *source, waiter_base *waiter) noexcept;
+
+struct empty {};
+
+// Error types of a waiting operation that is resumed on Scheduler.
+template <typename Scheduler>
+struct _errors {
+  using type = concat_type_lists_unique_t<
+      typename callable_result_t<tag_t<schedule>, Scheduler &>::
+          template error_types<type_list>,
+      type_list<std::exception_ptr>>;
+};
+template <>
+struct _errors<void> {
+  using type = type_list<>;
+};
+
+template <typename Scheduler, typename Receiver>
+struct _schedule_op {
+  using type = manual_lifetime<operation_t<
+      callable_result_t<tag_t<schedule>, Scheduler &>, Receiver>>;
+};
+template <typename Receiver>
+struct _schedule_op<void, Receiver> {
+  using type = empty;
+};
+
+// Resumption of a waiting operation by scheduling onto a scheduler, shared
+// by the operations below and async_semaphore's acquire operations.
+//
+// The operation derives from resumable<Op, Scheduler, StopToken>, has
+// 'scheduler_' and 'receiver_' members and provides:
+//
+//   void resume_failed() noexcept
+//     Called if the operation completes with an error or done rather than
+//     being resumed, before the receiver is completed.
+//
+//   StopToken resume_stop_token() const noexcept
+//     The stop token passed to the schedule() operation.
+//
+// Scheduler is void if the operation is resumed inline, in which case
+// resume_on_scheduler() must not be called.
+template <typename Derived, typename Scheduler, typename StopToken>
+struct _resumable {
+  class type;
+};
+template <typename Derived, typename Scheduler, typename StopToken>
+using resumable = typename _resumable<Derived, Scheduler, StopToken>::type;
+
+template <typename Derived, typename Scheduler, typename StopToken>
+class _resumable<Derived, Scheduler, StopToken>::type {
+  using base = type;
+
+  struct resume_receiver {
+    base &op_;
+
+    void set_value() && noexcept {
+      op_.scheduleOp_.destruct();
+      unifex::set_value(std::move(op_.derived().receiver_));
+    }
+
+    template <typename Error>
+    void set_error(Error &&error) && noexcept {
+      std::decay_t<Error> e{(Error &&) error};
+      op_.scheduleOp_.destruct();
+      op_.derived().resume_failed();
+      unifex::set_error(std::move(op_.derived().receiver_), std::move(e));
+    }
+
+    void set_done() && noexcept {
+      op_.scheduleOp_.destruct();
+      op_.derived().resume_failed();
+      unifex::set_done(std::move(op_.derived().receiver_));
+    }
+
+    friend StopToken tag_invoke(
+        tag_t<get_stop_token>, const resume_receiver &r) noexcept {
+      return r.stop_token();
+    }
+
+  private:
+    StopToken stop_token() const noexcept {
+      return op_.derived().resume_stop_token();
+    }
+  };
+
+protected:
+  void resume_on_scheduler() noexcept {
+    try {
+      scheduleOp_.construct_from([&] {
+        return unifex::connect(
+            schedule(derived().scheduler_), resume_receiver{*this});
+      });
+    } catch (...) {
+      derived().resume_failed();
+      unifex::set_error(
+          std::move(derived().receiver_), std::current_exception());
+      return;
+    }
+    unifex::start(scheduleOp_.get());
+  }
+
+private:
+  Derived &derived() noexcept {
+    return static_cast<Derived &>(*this);
+  }
+
+  const Derived &derived() const noexcept {
+    return static_cast<const Derived &>(*this);
+  }
+
+  UNIFEX_NO_UNIQUE_ADDRESS
+  typename _schedule_op<Scheduler, resume_receiver>::type scheduleOp_;
+};
+
+template <typename Scheduler, typename Receiver>
+struct _op {
+  class type;
+};
+template <typename Scheduler, typename Receiver>
+using operation = typename _op<Scheduler, std::remove_cvref_t<Receiver>>::type;
+
+// Scheduler is void if the waiter is resumed inline on the thread that
+// releases it.
+template <typename Scheduler, typename Receiver>
+class _op<Scheduler, Receiver>::type
+  : waiter_base,
+    resumable<
+        typename _op<Scheduler, Receiver>::type,
+        Scheduler,
+        unstoppable_token> {
+  using base = resumable<type, Scheduler, unstoppable_token>;
+  friend base;
+
+  static constexpr bool resume_inline = std::is_void_v<Scheduler>;
+  using scheduler_type = std::conditional_t<resume_inline, empty, Scheduler>;
+
+public:
+  template <typename Receiver2>
+  explicit type(
+      void *source,
+      enqueue_fn *enqueue,
+      scheduler_type &&scheduler,
+      Receiver2 &&r) noexcept(std::is_nothrow_constructible_v<Receiver,
+                                                              Receiver2>)
+    : source_(source),
+      enqueue_(enqueue),
+      scheduler_(std::move(scheduler)),
+      receiver_((Receiver2 &&) r) {
+    this->resume_ = [](waiter_base *self) noexcept {
+      static_cast<type *>(self)->resume();
+    };
+  }
+
+  type(type &&) = delete;
+
+  friend void tag_invoke(tag_t<start>, type &op) noexcept {
+    if (!op.enqueue_(op.source_, &op)) {
+      // Already released. Invoke the continuation inline
+      // without type-erasure here.
+      unifex::set_value(std::move(op.receiver_));
+    }
+  }
+
+private:
+  void resume() noexcept {
+    if constexpr (resume_inline) {
+      unifex::set_value(std::move(receiver_));
+    } else {
+      this->resume_on_scheduler();
+    }
+  }
+
+  void resume_failed() noexcept {}
+
+  // Waiting operations do not respond to stop requests.
+  unstoppable_token resume_stop_token() const noexcept {
+    return {};
+  }
+
+  void *source_;
+  enqueue_fn *enqueue_;
+  UNIFEX_NO_UNIQUE_ADDRESS scheduler_type scheduler_;
+  Receiver receiver_;
+};
+
+template <typename Scheduler>
+struct _sender {
+  class type;
+};
+template <typename Scheduler>
+using sender = typename _sender<Scheduler>::type;
+
+template <typename Scheduler>
+class _sender<Scheduler>::type {
+  using scheduler_type =
+      std::conditional_t<std::is_void_v<Scheduler>, empty, Scheduler>;
+
+public:
+  template <template <typename...> class Variant,
+            template <typename...> class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types =
+      typename _errors<Scheduler>::type::template apply<Variant>;
+
+  template <typename Scheduler2>
+  explicit type(void *source, enqueue_fn *enqueue, Scheduler2 &&scheduler)
+      noexcept(std::is_nothrow_constructible_v<scheduler_type, Scheduler2>)
+    : source_(source),
+      enqueue_(enqueue),
+      scheduler_((Scheduler2 &&) scheduler) {}
+
+  template <typename Receiver>
+  operation<Scheduler, Receiver> connect(Receiver &&r) && {
+    return operation<Scheduler, Receiver>{
+        source_, enqueue_, std::move(scheduler_), (Receiver &&) r};
+  }
+
+private:
+  void *source_;
+  enqueue_fn *enqueue_;
+  UNIFEX_NO_UNIQUE_ADDRESS scheduler_type scheduler_;
+};
+
+} // namespace _async_wait
+} // namespace unifex
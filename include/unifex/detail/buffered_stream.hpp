@@ -0,0 +1,472 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _buffered {
+
+// Machinery shared by stream adapters that read their source stream ahead
+// of the consumer, with at most one next() on the source stream in flight
+// at a time, and hand buffered results to the consumer's next() (eg.
+// prefetch_stream(), batch_stream() and transform_stream_concurrent()).
+//
+// The adapter's state derives from state_base<State, Stream> and provides:
+//
+//   value_type
+//   value_types<Variant, Tuple>
+//     The result handed to the consumer and the value_types of next().
+//
+//   bool try_take(waiter_base*, std::optional<value_type>&, std::exception_ptr&)
+//     Either fills in the next result for the consumer (a value, an error
+//     or neither for the end of the stream) and returns true, or parks the
+//     waiter in consumer_ and returns false.
+//
+//   static void deliver_value(Receiver&&, value_type&&)
+//     Sends a value taken by try_take() to the consumer.
+//
+//   void fetch_value(Values&&...)
+//   void end_fetch(std::exception_ptr)
+//     Called when the in-flight next() on the source stream completes with
+//     a value, or with done or an error. fetch_value() must call
+//     destroy_fetch() once it no longer needs the values.
+//
+//   void discard()
+//   bool in_flight()
+//     Called with the mutex held to discard buffered results on cleanup
+//     and to query whether any operations are still running.
+
+struct waiter_base {
+  void (*resume_)(waiter_base*) noexcept;
+};
+
+template <typename State>
+struct _fetch_receiver {
+  class type;
+};
+template <typename State>
+using fetch_receiver = typename _fetch_receiver<State>::type;
+
+template <typename State>
+class _fetch_receiver<State>::type {
+ public:
+  explicit type(State& s) noexcept : state_(s) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) && noexcept {
+    state_.fetch_value((Values &&) values...);
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    if constexpr (std::is_same_v<
+                      std::remove_cvref_t<Error>,
+                      std::exception_ptr>) {
+      state_.fetch_end((Error &&) error);
+    } else {
+      state_.fetch_end(std::make_exception_ptr((Error &&) error));
+    }
+  }
+
+  void set_done() && noexcept {
+    state_.fetch_end(nullptr);
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_token();
+  }
+
+ private:
+  State& state_;
+};
+
+template <typename Derived, typename Stream>
+struct _state_base {
+  class type;
+};
+template <typename Derived, typename Stream>
+using state_base = typename _state_base<Derived, Stream>::type;
+
+template <typename Derived, typename Stream>
+class _state_base<Derived, Stream>::type {
+  template <typename State>
+  friend struct _fetch_receiver;
+
+ public:
+  using stream_type = Stream;
+
+  type(type&&) = delete;
+
+  ~type() {
+    assert(!fetching_);
+  }
+
+  // Un-parks 'waiter' unless it has already been resumed.
+  // Returns true if it was un-parked.
+  bool try_cancel(waiter_base* waiter) noexcept {
+    std::lock_guard lock{mutex_};
+    if (consumer_ != waiter) {
+      return false;
+    }
+    consumer_ = nullptr;
+    return true;
+  }
+
+  // Stops reading the source stream and discards any buffered results.
+  //
+  // Returns false if 'waiter' has been parked until the operations still
+  // in flight have completed. Otherwise, the source stream can be cleaned
+  // up immediately.
+  bool stop(waiter_base* waiter) noexcept {
+    // Requested before taking the lock as the in-flight operations may
+    // complete synchronously inside request_stop().
+    stopSource_.request_stop();
+
+    std::lock_guard lock{mutex_};
+    stopping_ = true;
+    derived().discard();
+    if (derived().in_flight()) {
+      cleanup_ = waiter;
+      return false;
+    }
+    return true;
+  }
+
+  Stream& stream() noexcept {
+    return stream_;
+  }
+
+  inplace_stop_token get_token() noexcept {
+    return stopSource_.get_token();
+  }
+
+ protected:
+  template <typename Stream2>
+  explicit type(Stream2&& stream) : stream_((Stream2 &&) stream) {}
+
+  // Starts the next() on the source stream. fetching_ must have been set.
+  void fetch() noexcept {
+    try {
+      fetchOp_.construct_from([&] {
+        return unifex::connect(
+            next(stream_), fetch_receiver<Derived>{derived()});
+      });
+    } catch (...) {
+      derived().end_fetch(std::current_exception());
+      return;
+    }
+    unifex::start(fetchOp_.get());
+  }
+
+  void destroy_fetch() noexcept {
+    fetchOp_.destruct();
+  }
+
+  // Called after stop() once an operation has been marked as no longer in
+  // flight. Releases 'lock' and resumes the cleanup if none remain.
+  void stopped(std::unique_lock<std::mutex> lock) noexcept {
+    if (derived().in_flight()) {
+      return;
+    }
+    waiter_base* cleanup = std::exchange(cleanup_, nullptr);
+    lock.unlock();
+    resume(cleanup);
+  }
+
+  static void resume(waiter_base* waiter) noexcept {
+    if (waiter != nullptr) {
+      waiter->resume_(waiter);
+    }
+  }
+
+  Stream stream_;
+  std::mutex mutex_;
+  bool fetching_ = false;
+  bool stopping_ = false;
+  waiter_base* consumer_ = nullptr;
+  waiter_base* cleanup_ = nullptr;
+
+ private:
+  using fetch_op_t = next_operation_t<Stream, fetch_receiver<Derived>>;
+
+  Derived& derived() noexcept {
+    return static_cast<Derived&>(*this);
+  }
+
+  void fetch_end(std::exception_ptr error) noexcept {
+    fetchOp_.destruct();
+    derived().end_fetch(std::move(error));
+  }
+
+  inplace_stop_source stopSource_;
+  manual_lifetime<fetch_op_t> fetchOp_;
+};
+
+template <typename State, typename Receiver>
+struct _next_op {
+  class type;
+};
+template <typename State, typename Receiver>
+using next_operation =
+    typename _next_op<State, std::remove_cvref_t<Receiver>>::type;
+
+template <typename State, typename Receiver>
+class _next_op<State, Receiver>::type : waiter_base {
+  using value_type = typename State::value_type;
+
+ public:
+  template <typename Receiver2>
+  explicit type(State& s, Receiver2&& r)
+    : state_(s), receiver_((Receiver2 &&) r) {
+    this->resume_ = [](waiter_base* self) noexcept {
+      static_cast<type*>(self)->run();
+    };
+  }
+
+  type(type&&) = delete;
+
+  void start() noexcept {
+    if constexpr (stop_possible) {
+      // Pass a copy: construct() moves from its arguments.
+      stopCallback_.construct(
+          stop_token_type{get_stop_token(receiver_)}, cancel_callback{*this});
+    }
+    run();
+  }
+
+ private:
+  using stop_token_type = stop_token_type_t<Receiver&>;
+  static constexpr bool stop_possible =
+      !is_stop_never_possible_v<stop_token_type>;
+
+  struct cancel_callback {
+    type& op_;
+
+    void operator()() noexcept {
+      if (op_.state_.try_cancel(&op_)) {
+        op_.destroy_callback();
+        unifex::set_done(std::move(op_.receiver_));
+      }
+    }
+  };
+
+  void run() noexcept {
+    if constexpr (stop_possible) {
+      if (get_stop_token(receiver_).stop_requested()) {
+        destroy_callback();
+        unifex::set_done(std::move(receiver_));
+        return;
+      }
+    }
+
+    std::optional<value_type> value;
+    std::exception_ptr error;
+    if (!state_.try_take(this, value, error)) {
+      return;
+    }
+
+    destroy_callback();
+    if (value.has_value()) {
+      State::deliver_value(std::move(receiver_), std::move(*value));
+    } else if (error) {
+      unifex::set_error(std::move(receiver_), std::move(error));
+    } else {
+      unifex::set_done(std::move(receiver_));
+    }
+  }
+
+  void destroy_callback() noexcept {
+    if constexpr (stop_possible) {
+      stopCallback_.destruct();
+    }
+  }
+
+  struct empty {};
+
+  State& state_;
+  Receiver receiver_;
+  UNIFEX_NO_UNIQUE_ADDRESS std::conditional_t<
+      stop_possible,
+      manual_lifetime<
+          typename stop_token_type::template callback_type<cancel_callback>>,
+      empty>
+      stopCallback_;
+};
+
+template <typename State>
+struct _next_sender {
+  class type;
+};
+template <typename State>
+using next_sender = typename _next_sender<State>::type;
+
+template <typename State>
+class _next_sender<State>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = typename State::template value_types<Variant, Tuple>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  explicit type(State& s) noexcept : state_(s) {}
+
+  template <typename Receiver>
+  next_operation<State, Receiver> connect(Receiver&& r) && {
+    return next_operation<State, Receiver>{state_, (Receiver &&) r};
+  }
+
+ private:
+  State& state_;
+};
+
+template <typename State, typename Receiver>
+struct _cleanup_op {
+  class type;
+};
+template <typename State, typename Receiver>
+using cleanup_operation =
+    typename _cleanup_op<State, std::remove_cvref_t<Receiver>>::type;
+
+template <typename State, typename Receiver>
+class _cleanup_op<State, Receiver>::type : waiter_base {
+  using stream_type = typename State::stream_type;
+
+ public:
+  template <typename Receiver2>
+  explicit type(State& s, Receiver2&& r)
+    : state_(s), receiver_((Receiver2 &&) r) {
+    this->resume_ = [](waiter_base* self) noexcept {
+      static_cast<type*>(self)->cleanup_source();
+    };
+  }
+
+  type(type&&) = delete;
+
+  ~type() {
+    if (started_) {
+      innerOp_.destruct();
+    }
+  }
+
+  void start() noexcept {
+    if (state_.stop(this)) {
+      cleanup_source();
+    }
+  }
+
+ private:
+  void cleanup_source() noexcept {
+    try {
+      innerOp_.construct_from([&] {
+        return unifex::connect(
+            cleanup(state_.stream()), std::move(receiver_));
+      });
+    } catch (...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+      return;
+    }
+    started_ = true;
+    unifex::start(innerOp_.get());
+  }
+
+  State& state_;
+  Receiver receiver_;
+  bool started_ = false;
+  manual_lifetime<cleanup_operation_t<stream_type, Receiver>> innerOp_;
+};
+
+template <typename State>
+struct _cleanup_sender {
+  class type;
+};
+template <typename State>
+using cleanup_sender = typename _cleanup_sender<State>::type;
+
+template <typename State>
+class _cleanup_sender<State>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      typename cleanup_sender_t<typename State::stream_type>::
+          template error_types<type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  explicit type(State& s) noexcept : state_(s) {}
+
+  template <typename Receiver>
+  cleanup_operation<State, Receiver> connect(Receiver&& r) && {
+    return cleanup_operation<State, Receiver>{state_, (Receiver &&) r};
+  }
+
+ private:
+  State& state_;
+};
+
+template <typename State>
+struct _stream {
+  class type;
+};
+template <typename State>
+using stream = typename _stream<State>::type;
+
+// The adapted stream. The state is heap-allocated so that its address is
+// stable while operations on the source stream are in flight.
+template <typename State>
+class _stream<State>::type {
+ public:
+  explicit type(std::unique_ptr<State> state) noexcept
+    : state_(std::move(state)) {}
+
+  friend next_sender<State> tag_invoke(tag_t<next>, type& s) noexcept {
+    return next_sender<State>{*s.state_};
+  }
+
+  friend cleanup_sender<State> tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return cleanup_sender<State>{*s.state_};
+  }
+
+ private:
+  std::unique_ptr<State> state_;
+};
+
+} // namespace _buffered
+} // namespace unifex
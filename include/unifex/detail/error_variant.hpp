@@ -0,0 +1,111 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace unifex {
+namespace detail {
+
+// Errors are stored as the sender's declared error_types so that, for
+// example, a std::error_code can be reported without allocating an
+// exception_ptr. Any other error type is wrapped in an exception_ptr.
+template <typename Sender>
+using error_variant_t = typename concat_type_lists_unique_t<
+    typename Sender::template error_types<type_list>,
+    type_list<std::exception_ptr>>::template apply<std::variant>;
+
+template <typename T, typename ErrorVariant>
+inline constexpr bool is_alternative_v = false;
+
+template <typename T, typename... Errors>
+inline constexpr bool is_alternative_v<T, std::variant<Errors...>> =
+    is_one_of_v<T, Errors...>;
+
+// Constructs 'storage' from 'error', falling back to an exception_ptr if
+// 'error' is not one of the alternatives or if copying it throws.
+template <typename ErrorVariant, typename Error>
+void store_error(
+    manual_lifetime<ErrorVariant>& storage, Error&& error) noexcept {
+  using error_t = std::remove_cvref_t<Error>;
+  if constexpr (is_alternative_v<error_t, ErrorVariant>) {
+    try {
+      storage.construct_from([&] {
+        return ErrorVariant{std::in_place_type<error_t>, (Error &&) error};
+      });
+    } catch (...) {
+      storage.construct(
+          std::in_place_type<std::exception_ptr>, std::current_exception());
+    }
+  } else {
+    storage.construct(
+        std::in_place_type<std::exception_ptr>,
+        std::make_exception_ptr((Error &&) error));
+  }
+}
+
+template <typename Result, typename ErrorVariant>
+struct _or_error;
+
+template <typename Result, typename... Errors>
+struct _or_error<Result, std::variant<Errors...>> {
+  using type = std::variant<std::optional<Result>, Errors...>;
+};
+
+// The result of waiting for a sender without throwing its error: the value,
+// or std::nullopt for set_done(), followed by the error alternatives.
+template <typename Result, typename ErrorVariant>
+using or_error_t = typename _or_error<Result, ErrorVariant>::type;
+
+// Moves the error in 'error' into the matching alternative of 'OrError'.
+template <typename OrError, typename ErrorVariant>
+OrError to_or_error(ErrorVariant&& error) {
+  return std::visit(
+      [](auto&& e) -> OrError {
+        return OrError{
+            std::in_place_type<std::remove_cvref_t<decltype(e)>>,
+            std::move(e)};
+      },
+      std::move(error));
+}
+
+// Rethrows a stored exception_ptr, or throws any other error by value.
+template <typename ErrorVariant>
+[[noreturn]] void throw_error(ErrorVariant&& error) {
+  std::visit(
+      [](auto&& e) {
+        if constexpr (std::is_same_v<
+                          std::remove_cvref_t<decltype(e)>,
+                          std::exception_ptr>) {
+          std::rethrow_exception(e);
+        } else {
+          throw std::move(e);
+        }
+      },
+      std::move(error));
+  std::terminate();
+}
+
+} // namespace detail
+} // namespace unifex
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/async_trace.hpp>
+#include <unifex/config.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _fork_join {
+
+// Machinery shared by operations that split a range into chunks, run them
+// concurrently on a scheduler and complete once all of them have finished
+// (eg. indexed_for() with the parallel_policy and parallel_reduce()).
+//
+// All but one of the chunks are forked onto the scheduler and the last one
+// is run inline. Whichever chunk finishes last delivers the result.
+//
+// The operation derives from chunked_op_base<Op, Scheduler, Receiver,
+// SizeType>, has 'scheduler_' and 'receiver_' members and provides:
+//
+//   void run_chunk(SizeType index)
+//     Runs the chunk with the given index. May throw.
+//
+//   void join()
+//     Delivers the result to 'receiver_' once every chunk has completed
+//     successfully. May throw.
+
+template <typename Derived, typename Scheduler, typename Receiver, typename SizeType>
+struct _chunked_op_base {
+  class type;
+};
+template <typename Derived, typename Scheduler, typename Receiver, typename SizeType>
+using chunked_op_base =
+    typename _chunked_op_base<Derived, Scheduler, Receiver, SizeType>::type;
+
+template <typename Derived, typename Scheduler, typename Receiver, typename SizeType>
+class _chunked_op_base<Derived, Scheduler, Receiver, SizeType>::type {
+  using base = type;
+
+  struct chunk_receiver {
+    base* op_;
+    SizeType index_;
+
+    void set_value() && noexcept {
+      op_->execute_chunk(index_);
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      if constexpr (std::is_same_v<std::remove_cvref_t<Error>, std::exception_ptr>) {
+        op_->record_error((Error &&) error);
+      } else {
+        op_->record_error(std::make_exception_ptr((Error &&) error));
+      }
+      op_->chunk_complete();
+    }
+
+    void set_done() && noexcept {
+      op_->done_.store(true, std::memory_order_relaxed);
+      op_->chunk_complete();
+    }
+
+    template <
+        typename CPO,
+        std::enable_if_t<!is_receiver_cpo_v<CPO>, int> = 0>
+    friend auto tag_invoke(CPO cpo, const chunk_receiver& r) noexcept(
+        is_nothrow_callable_v<CPO, const Receiver&>)
+        -> callable_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(r.get_receiver());
+    }
+
+    template <typename Visit>
+    friend void tag_invoke(
+        tag_t<visit_continuations>,
+        const chunk_receiver& r,
+        Visit&& visit) {
+      std::invoke(visit, r.get_receiver());
+    }
+
+   private:
+    const Receiver& get_receiver() const noexcept {
+      return std::as_const(op_->derived().receiver_);
+    }
+  };
+
+  using chunk_op_t = operation_t<
+      callable_result_t<tag_t<schedule>, Scheduler&>,
+      chunk_receiver>;
+
+ public:
+  type() = default;
+  type(type&&) = delete;
+
+ protected:
+  static SizeType chunk_count(SizeType size) noexcept {
+    // A few chunks per hardware thread gives some slack for load-balancing.
+    const SizeType maxChunks = static_cast<SizeType>(
+        4 * std::max(std::thread::hardware_concurrency(), 1u));
+    return std::max<SizeType>(std::min(size, maxChunks), 1);
+  }
+
+  // The start of the chunk with the given index when splitting 'size'
+  // elements into 'chunkCount_' chunks.
+  SizeType chunk_begin(SizeType size, SizeType index) const noexcept {
+    return size * index / chunkCount_;
+  }
+
+  // Runs 'chunkCount' chunks, of which 'chunkCount - 1' are forked onto the
+  // scheduler, and completes the receiver once they have all finished.
+  void fork_chunks(SizeType chunkCount) noexcept {
+    chunkCount_ = chunkCount;
+    remaining_.store(chunkCount, std::memory_order_relaxed);
+
+    SizeType forked = 0;
+    try {
+      if (chunkCount > 1) {
+        chunkOps_.reset(new manual_lifetime<chunk_op_t>[chunkCount - 1]);
+      }
+      for (; forked + 1 < chunkCount; ++forked) {
+        auto& chunkOp = chunkOps_[forked].construct_from([&] {
+          return connect(
+              schedule(derived().scheduler_), chunk_receiver{this, forked});
+        });
+        forkedCount_ = forked + 1;
+        unifex::start(chunkOp);
+      }
+    } catch (...) {
+      record_error(std::current_exception());
+      // Account for the chunks that will now never run.
+      remaining_.fetch_sub(chunkCount - 1 - forked, std::memory_order_relaxed);
+    }
+
+    execute_chunk(chunkCount - 1);
+  }
+
+  SizeType chunkCount_ = 0;
+
+ private:
+  Derived& derived() noexcept {
+    return static_cast<Derived&>(*this);
+  }
+
+  void execute_chunk(SizeType index) noexcept {
+    try {
+      derived().run_chunk(index);
+    } catch (...) {
+      record_error(std::current_exception());
+    }
+    chunk_complete();
+  }
+
+  void record_error(std::exception_ptr ex) noexcept {
+    if (!hasError_.exchange(true, std::memory_order_relaxed)) {
+      error_ = std::move(ex);
+    }
+  }
+
+  void chunk_complete() noexcept {
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+
+    for (SizeType i = 0; i < forkedCount_; ++i) {
+      chunkOps_[i].destruct();
+    }
+    chunkOps_.reset();
+
+    auto& receiver = derived().receiver_;
+    if (hasError_.load(std::memory_order_relaxed)) {
+      unifex::set_error(std::move(receiver), std::move(error_));
+    } else if (done_.load(std::memory_order_relaxed)) {
+      unifex::set_done(std::move(receiver));
+    } else {
+      try {
+        derived().join();
+      } catch (...) {
+        unifex::set_error(std::move(receiver), std::current_exception());
+      }
+    }
+  }
+
+  std::unique_ptr<manual_lifetime<chunk_op_t>[]> chunkOps_;
+  SizeType forkedCount_ = 0;
+  std::atomic<SizeType> remaining_{0};
+  std::atomic<bool> hasError_{false};
+  std::atomic<bool> done_{false};
+  std::exception_ptr error_;
+};
+
+} // namespace _fork_join
+} // namespace unifex
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+
+// UNIFEX_HARDWARE_DESTRUCTIVE_INTERFERENCE_SIZE
+//
+// The minimum offset between two objects that are written by different
+// threads such that they do not end up sharing a cache-line.
+//
+// We deliberately don't use std::hardware_destructive_interference_size
+// here as its value is allowed to vary between compiler flags (eg. -mtune)
+// which would make the layout of types in headers ABI-unstable.
+// Define this macro before including unifex headers to override.
+#ifndef UNIFEX_HARDWARE_DESTRUCTIVE_INTERFERENCE_SIZE
+#if defined(__aarch64__) && defined(__APPLE__)
+#define UNIFEX_HARDWARE_DESTRUCTIVE_INTERFERENCE_SIZE 128
+#elif defined(__powerpc64__)
+#define UNIFEX_HARDWARE_DESTRUCTIVE_INTERFERENCE_SIZE 128
+#else
+#define UNIFEX_HARDWARE_DESTRUCTIVE_INTERFERENCE_SIZE 64
+#endif
+#endif
+
+namespace unifex {
+
+inline constexpr std::size_t hardware_destructive_interference_size =
+    UNIFEX_HARDWARE_DESTRUCTIVE_INTERFERENCE_SIZE;
+
+} // namespace unifex
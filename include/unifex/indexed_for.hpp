@@ -18,14 +18,20 @@
 #include <unifex/config.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
 #include <unifex/type_traits.hpp>
 #include <unifex/type_list.hpp>
 #include <unifex/blocking.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/async_trace.hpp>
 
+#include <unifex/detail/fork_join.hpp>
+
+#include <exception>
 #include <functional>
+#include <tuple>
 #include <type_traits>
+#include <variant>
 
 namespace execution {
 class sequenced_policy;
@@ -111,24 +117,205 @@ struct _receiver<Policy, Range, Func, Receiver>::type {
   }
 };
 
-template <typename Predecessor, typename Policy, typename Range, typename Func>
+// Placeholder for the scheduler of an indexed_for() that was not given one
+// explicitly. The scheduler is obtained from the receiver instead.
+struct receiver_scheduler {};
+
+template <
+    typename Predecessor,
+    typename Range,
+    typename Func,
+    typename Scheduler,
+    typename Receiver>
+struct _par_op {
+  class type;
+};
+template <
+    typename Predecessor,
+    typename Range,
+    typename Func,
+    typename Scheduler,
+    typename Receiver>
+using par_operation = typename _par_op<
+    Predecessor,
+    Range,
+    Func,
+    Scheduler,
+    std::remove_cvref_t<Receiver>>::type;
+
+// The parallel_policy version when a scheduler is available.
+//
+// Once the predecessor completes, the range is split into chunks which are
+// run concurrently on the scheduler.
+template <
+    typename Predecessor,
+    typename Range,
+    typename Func,
+    typename Scheduler,
+    typename Receiver>
+class _par_op<Predecessor, Range, Func, Scheduler, Receiver>::type
+  : public _fork_join::chunked_op_base<
+        typename _par_op<Predecessor, Range, Func, Scheduler, Receiver>::type,
+        Scheduler,
+        Receiver,
+        decltype(std::declval<Range&>().size())> {
+  using operation = type;
+  using size_type = decltype(std::declval<Range&>().size());
+  using base =
+      _fork_join::chunked_op_base<type, Scheduler, Receiver, size_type>;
+  friend base;
+
+  template <typename... Values>
+  using value_variant = std::variant<std::monostate, Values...>;
+  using values_type = typename std::remove_cvref_t<Predecessor>::
+      template value_types<value_variant, decayed_tuple<std::tuple>::apply>;
+
+  struct predecessor_receiver {
+    operation* op_;
+
+    template <typename... Values>
+    void set_value(Values&&... values) && noexcept {
+      operation& op = *op_;
+      try {
+        op.values_.template emplace<std::tuple<std::remove_cvref_t<Values>...>>(
+            (Values &&) values...);
+      } catch (...) {
+        unifex::set_error(std::move(op.receiver_), std::current_exception());
+        return;
+      }
+      op.fork_chunks(base::chunk_count(op.range_.size()));
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      unifex::set_error(std::move(op_->receiver_), (Error &&) error);
+    }
+
+    void set_done() && noexcept {
+      unifex::set_done(std::move(op_->receiver_));
+    }
+
+    template <
+        typename CPO,
+        std::enable_if_t<!is_receiver_cpo_v<CPO>, int> = 0>
+    friend auto tag_invoke(CPO cpo, const predecessor_receiver& r) noexcept(
+        is_nothrow_callable_v<CPO, const Receiver&>)
+        -> callable_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(std::as_const(r.op_->receiver_));
+    }
+
+    template <typename Visit>
+    friend void tag_invoke(
+        tag_t<visit_continuations>,
+        const predecessor_receiver& r,
+        Visit&& visit) {
+      std::invoke(visit, r.op_->receiver_);
+    }
+  };
+
+ public:
+  template <typename Scheduler2, typename Receiver2>
+  explicit type(
+      Predecessor&& pred,
+      Range&& range,
+      Func&& func,
+      Scheduler2&& scheduler,
+      Receiver2&& receiver)
+    : func_((Func &&) func),
+      range_((Range &&) range),
+      scheduler_((Scheduler2 &&) scheduler),
+      receiver_((Receiver2 &&) receiver),
+      predOp_(connect((Predecessor &&) pred, predecessor_receiver{this})) {}
+
+  void start() & noexcept {
+    unifex::start(predOp_);
+  }
+
+ private:
+  void run_chunk(size_type index) {
+    const size_type size = range_.size();
+    const size_type begin = this->chunk_begin(size, index);
+    const size_type end = this->chunk_begin(size, index + 1);
+    std::visit(
+        [&](auto& values) {
+          if constexpr (!std::is_same_v<
+                            std::remove_cvref_t<decltype(values)>,
+                            std::monostate>) {
+            std::apply(
+                [&](auto&... vs) {
+                  auto first = range_.begin();
+                  for (size_type idx = begin; idx < end; ++idx) {
+                    std::invoke(func_, first[idx], vs...);
+                  }
+                },
+                values);
+          }
+        },
+        values_);
+  }
+
+  void join() {
+    std::visit(
+        [&](auto& values) {
+          if constexpr (!std::is_same_v<
+                            std::remove_cvref_t<decltype(values)>,
+                            std::monostate>) {
+            std::apply(
+                [&](auto&... vs) {
+                  unifex::set_value(std::move(receiver_), std::move(vs)...);
+                },
+                values);
+          }
+        },
+        values_);
+  }
+
+  UNIFEX_NO_UNIQUE_ADDRESS Func func_;
+  UNIFEX_NO_UNIQUE_ADDRESS Range range_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+  UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+  values_type values_;
+  operation_t<Predecessor, predecessor_receiver> predOp_;
+};
+
+template <
+    typename Predecessor,
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Scheduler>
 struct _sender {
   struct type;
 };
-template <typename Predecessor, typename Policy, typename Range, typename Func>
+template <
+    typename Predecessor,
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Scheduler = receiver_scheduler>
 using sender = typename _sender<
     std::remove_cvref_t<Predecessor>,
     std::decay_t<Policy>,
     std::decay_t<Range>,
-    std::decay_t<Func>>::type;
+    std::decay_t<Func>,
+    std::decay_t<Scheduler>>::type;
 
-template <typename Predecessor, typename Policy, typename Range, typename Func>
-struct _sender<Predecessor, Policy, Range, Func>::type {
+template <
+    typename Predecessor,
+    typename Policy,
+    typename Range,
+    typename Func,
+    typename Scheduler>
+struct _sender<Predecessor, Policy, Range, Func, Scheduler>::type {
   using sender = type;
   UNIFEX_NO_UNIQUE_ADDRESS Predecessor pred_;
   UNIFEX_NO_UNIQUE_ADDRESS Policy policy_;
   UNIFEX_NO_UNIQUE_ADDRESS Range range_;
   UNIFEX_NO_UNIQUE_ADDRESS Func func_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+
+  static constexpr bool is_parallel =
+      std::is_same_v<Policy, execution::parallel_policy>;
 
   template <
       template <typename...> class Variant,
@@ -143,18 +330,51 @@ struct _sender<Predecessor, Policy, Range, Func>::type {
   friend constexpr auto tag_invoke(
       tag_t<blocking>,
       const sender& sender) {
-    return blocking(sender.pred_);
+    if constexpr (is_parallel) {
+      // Chunks only run once the predecessor has completed, so if that
+      // never happens inline then neither does the result, whether or not
+      // a scheduler turns out to be available. Otherwise the result may be
+      // delivered on one of the scheduler's threads.
+      const blocking_kind predBlocking = blocking(sender.pred_);
+      if (predBlocking == blocking_kind::never) {
+        return blocking_kind::never;
+      }
+      return blocking_kind::maybe;
+    } else {
+      return blocking(sender.pred_);
+    }
   }
 
   template <typename Receiver>
   auto connect(Receiver&& receiver) && {
-    return unifex::connect(
-        std::forward<Predecessor>(pred_),
-        _ifor::receiver<Policy, Range, Func, Receiver>{
-            std::move(func_),
-            std::move(policy_),
-            std::move(range_),
-            std::move(receiver)});
+    if constexpr (is_parallel && !std::is_same_v<Scheduler, receiver_scheduler>) {
+      return par_operation<Predecessor, Range, Func, Scheduler, Receiver>{
+          std::forward<Predecessor>(pred_),
+          std::move(range_),
+          std::move(func_),
+          std::move(scheduler_),
+          std::move(receiver)};
+    } else if constexpr (
+        is_parallel &&
+        is_callable_v<tag_t<get_scheduler>, const std::remove_cvref_t<Receiver>&>) {
+      using receiver_scheduler_t = std::decay_t<
+          callable_result_t<tag_t<get_scheduler>, const std::remove_cvref_t<Receiver>&>>;
+      auto scheduler = get_scheduler(std::as_const(receiver));
+      return par_operation<Predecessor, Range, Func, receiver_scheduler_t, Receiver>{
+          std::forward<Predecessor>(pred_),
+          std::move(range_),
+          std::move(func_),
+          std::move(scheduler),
+          std::move(receiver)};
+    } else {
+      return unifex::connect(
+          std::forward<Predecessor>(pred_),
+          _ifor::receiver<Policy, Range, Func, Receiver>{
+              std::move(func_),
+              std::move(policy_),
+              std::move(range_),
+              std::move(receiver)});
+    }
   }
 };
 } // namespace _ifor
@@ -165,7 +385,34 @@ namespace _ifor_cpo {
     auto operator()(Sender&& predecessor, Policy&& policy, Range&& range, Func&& func) const
         -> _ifor::sender<Sender, Policy, Range, Func> {
       return _ifor::sender<Sender, Policy, Range, Func>{
-          std::move(predecessor), std::move(policy), std::move(range), std::move(func)};
+          std::move(predecessor),
+          std::move(policy),
+          std::move(range),
+          std::move(func),
+          _ifor::receiver_scheduler{}};
+    }
+
+    // With parallel_policy, runs chunks of the range on 'scheduler' rather
+    // than on the scheduler obtained from the receiver.
+    template <
+        typename Sender,
+        typename Policy,
+        typename Range,
+        typename Func,
+        typename Scheduler>
+    auto operator()(
+        Sender&& predecessor,
+        Policy&& policy,
+        Range&& range,
+        Func&& func,
+        Scheduler&& scheduler) const
+        -> _ifor::sender<Sender, Policy, Range, Func, Scheduler> {
+      return _ifor::sender<Sender, Policy, Range, Func, Scheduler>{
+          std::move(predecessor),
+          std::move(policy),
+          std::move(range),
+          std::move(func),
+          std::move(scheduler)};
     }
   } indexed_for{};
 } // namespace _ifor_cpo
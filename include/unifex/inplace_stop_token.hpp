@@ -21,12 +21,15 @@
 #include <atomic>
 #include <cassert>
 #include <thread>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
+#include <utility>
 
 namespace unifex {
 
 class inplace_stop_source;
+class inplace_stop_child_source;
 class inplace_stop_token;
 template <typename F>
 class inplace_stop_callback;
@@ -42,6 +45,8 @@ class inplace_stop_callback_base {
   friend inplace_stop_source;
 
   inplace_stop_source* source_;
+  // Set if registered in one of the source's slots rather than its list.
+  std::atomic<inplace_stop_callback_base*>* slot_ = nullptr;
   inplace_stop_callback_base* next_ = nullptr;
   inplace_stop_callback_base** prevPtr_ = nullptr;
   bool* removedDuringCallback_ = nullptr;
@@ -64,14 +69,20 @@ class inplace_stop_source {
   inplace_stop_token get_token() noexcept;
 
   bool stop_requested() const noexcept {
-    return (state_.load(std::memory_order_acquire) & stop_requested_flag) != 0;
+    if ((state_.load(std::memory_order_acquire) & stop_requested_flag) != 0) {
+      return true;
+    }
+    return parent_ != nullptr && parent_->stop_requested();
   }
 
  private:
   friend inplace_stop_token;
+  friend inplace_stop_child_source;
   template <typename F>
   friend class inplace_stop_callback;
 
+  bool try_add_local_callback(inplace_stop_callback_base* callback) noexcept;
+
   std::uint8_t lock() noexcept;
   void unlock(std::uint8_t oldState) noexcept;
 
@@ -79,14 +90,69 @@ class inplace_stop_source {
 
   bool try_add_callback(inplace_stop_callback_base* callback) noexcept;
 
+  bool try_add_callback_to_list(inplace_stop_callback_base* callback) noexcept;
+
   void remove_callback(inplace_stop_callback_base* callback) noexcept;
 
+  void execute_callback(inplace_stop_callback_base* callback) noexcept;
+
+  void wait_for_callback(inplace_stop_callback_base* callback) noexcept;
+
   static constexpr std::uint8_t stop_requested_flag = 1;
   static constexpr std::uint8_t locked_flag = 2;
 
+  // Callbacks are first registered in one of a few slots with a single CAS,
+  // starting from a slot chosen per thread, so that registering and
+  // deregistering in the common case that stop is never requested doesn't
+  // take the lock. Callbacks that find no free slot go on the locked list.
+  static constexpr std::size_t slot_count = 8;
+
   std::atomic<std::uint8_t> state_{0};
+  std::atomic<inplace_stop_callback_base*> slots_[slot_count] = {};
   inplace_stop_callback_base* callbacks_ = nullptr;
   std::thread::id notifyingThreadId_;
+  // Only set for an inplace_stop_child_source.
+  inplace_stop_source* parent_ = nullptr;
+};
+
+// An inplace_stop_source on which stop is also requested when it is
+// requested on the parent token.
+//
+// Nothing is registered with the parent until a callback is registered with
+// this source, and stop_requested() checks the parent directly, so nesting
+// sources costs nothing for children that only poll for stop.
+class inplace_stop_child_source : public inplace_stop_source {
+ public:
+  explicit inplace_stop_child_source(inplace_stop_token parent) noexcept;
+
+  ~inplace_stop_child_source();
+
+  // Stops forwarding stop requests from the parent, which may then be
+  // destroyed. Must only be called once this source is no longer in use.
+  void unlink() noexcept;
+
+ private:
+  friend inplace_stop_source;
+
+  class link final : public inplace_stop_callback_base {
+   public:
+    link(inplace_stop_child_source& child, inplace_stop_source* parent) noexcept
+      : inplace_stop_callback_base(parent), child_(child) {}
+
+    bool attach() noexcept;
+    void detach() noexcept;
+
+    void execute() noexcept final;
+
+   private:
+    inplace_stop_child_source& child_;
+  };
+
+  // Registers link_ with the parent the first time it is needed.
+  void link_to_parent() noexcept;
+
+  link link_;
+  std::atomic<bool> linked_{false};
 };
 
 class inplace_stop_token {
@@ -112,6 +178,7 @@ class inplace_stop_token {
 
  private:
   friend inplace_stop_source;
+  friend inplace_stop_child_source;
   template <typename F>
   friend class inplace_stop_callback;
 
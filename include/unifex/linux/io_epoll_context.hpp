@@ -19,6 +19,7 @@
 #if !UNIFEX_NO_EPOLL
 
 #include <unifex/detail/atomic_intrusive_queue.hpp>
+#include <unifex/detail/hardware_interference_size.hpp>
 #include <unifex/detail/intrusive_heap.hpp>
 #include <unifex/detail/intrusive_queue.hpp>
 #include <unifex/get_stop_token.hpp>
@@ -180,7 +181,12 @@ class io_epoll_context {
   // Data that is modified by remote threads
 
   // Queue of operations enqueued by remote threads.
-  atomic_intrusive_queue<operation_base, &operation_base::next_> remoteQueue_;
+  //
+  // Kept on its own cache-line so that remote threads enqueueing work
+  // don't invalidate the line(s) holding the I/O thread's state above.
+  alignas(hardware_destructive_interference_size)
+      atomic_intrusive_queue<operation_base, &operation_base::next_>
+          remoteQueue_;
 };
 
 template <typename StopToken>
@@ -18,6 +18,7 @@
 #if !UNIFEX_NO_LIBURING
 
 #include <unifex/detail/atomic_intrusive_queue.hpp>
+#include <unifex/detail/hardware_interference_size.hpp>
 #include <unifex/detail/intrusive_heap.hpp>
 #include <unifex/detail/intrusive_queue.hpp>
 #include <unifex/file_concepts.hpp>
@@ -32,6 +33,10 @@
 #include <unifex/linux/monotonic_clock.hpp>
 #include <unifex/linux/safe_file_descriptor.hpp>
 
+#if !UNIFEX_NO_COROUTINES
+#include <unifex/coroutine.hpp>
+#endif
+
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -79,6 +84,10 @@ class io_uring_context {
     int result_;
   };
 
+#if !UNIFEX_NO_COROUTINES
+  class io_awaiter;
+#endif
+
   struct stop_operation : operation_base {
     stop_operation() noexcept {
       this->execute_ = [](operation_base * op) noexcept {
@@ -271,7 +280,12 @@ class io_uring_context {
   // Data that is modified by remote threads
 
   // Queue of operations enqueued by remote threads.
-  atomic_intrusive_queue<operation_base, &operation_base::next_> remoteQueue_;
+  //
+  // Kept on its own cache-line so that remote threads enqueueing work
+  // don't invalidate the line(s) holding the I/O thread's state above.
+  alignas(hardware_destructive_interference_size)
+      atomic_intrusive_queue<operation_base, &operation_base::next_>
+          remoteQueue_;
 };
 
 template <typename StopToken>
@@ -388,6 +402,100 @@ class io_uring_context::schedule_sender {
   io_uring_context& context_;
 };
 
+#if !UNIFEX_NO_COROUTINES
+// The awaitable returned by 'co_await'-ing a read_sender or write_sender.
+//
+// Rather than connecting a coroutine receiver to the sender and storing
+// the result in the awaiter, the completion holds the coroutine handle and
+// the I/O thread resumes the coroutine as soon as it processes the
+// completion-queue entry. The result is read directly from 'result_'.
+class io_uring_context::io_awaiter : private completion_base {
+  friend io_uring_context;
+
+ public:
+  explicit io_awaiter(
+      io_uring_context& context,
+      std::uint8_t opcode,
+      int fd,
+      std::int64_t offset,
+      void* data,
+      std::size_t size) noexcept
+      : context_(context), opcode_(opcode), fd_(fd), offset_(offset) {
+    buffer_[0].iov_base = data;
+    buffer_[0].iov_len = size;
+  }
+
+  io_awaiter(io_awaiter&&) = delete;
+
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  void await_suspend(coro::coroutine_handle<> continuation) noexcept {
+    continuation_ = continuation;
+    if (!context_.is_running_on_io_thread()) {
+      this->execute_ = &io_awaiter::on_schedule_complete;
+      context_.schedule_remote(this);
+    } else {
+      start_io();
+    }
+  }
+
+  // Produces the number of bytes transferred, or an empty optional if the
+  // operation was cancelled. Matches the result of awaiting the sender
+  // through sender_awaitable.
+  std::optional<ssize_t> await_resume() const {
+    if (this->result_ >= 0) {
+      return ssize_t(this->result_);
+    } else if (this->result_ == -ECANCELED) {
+      return std::nullopt;
+    }
+    throw std::error_code{-this->result_, std::system_category()};
+  }
+
+ private:
+  static void on_schedule_complete(operation_base* op) noexcept {
+    static_cast<io_awaiter*>(op)->start_io();
+  }
+
+  static void on_io_complete(operation_base* op) noexcept {
+    static_cast<io_awaiter*>(op)->continuation_.resume();
+  }
+
+  void start_io() noexcept {
+    assert(context_.is_running_on_io_thread());
+
+    auto populateSqe = [this](io_uring_sqe & sqe) noexcept {
+      sqe.opcode = opcode_;
+      sqe.flags = 0;
+      sqe.ioprio = 0;
+      sqe.fd = fd_;
+      sqe.off = offset_;
+      sqe.addr = reinterpret_cast<std::uintptr_t>(&buffer_[0]);
+      sqe.len = 1;
+      sqe.rw_flags = 0;
+      sqe.user_data = reinterpret_cast<std::uintptr_t>(
+          static_cast<completion_base*>(this));
+      sqe.__pad2[0] = sqe.__pad2[1] = sqe.__pad2[2] = 0;
+
+      this->execute_ = &io_awaiter::on_io_complete;
+    };
+
+    if (!context_.try_submit_io(populateSqe)) {
+      this->execute_ = &io_awaiter::on_schedule_complete;
+      context_.schedule_pending_io(this);
+    }
+  }
+
+  io_uring_context& context_;
+  std::uint8_t opcode_;
+  int fd_;
+  std::int64_t offset_;
+  iovec buffer_[1];
+  coro::coroutine_handle<> continuation_;
+};
+#endif // !UNIFEX_NO_COROUTINES
+
 class io_uring_context::read_sender {
   using offset_t = std::int64_t;
 
@@ -497,6 +605,15 @@ class io_uring_context::read_sender {
     return operation<std::remove_cvref_t<Receiver>>{*this, (Receiver &&) r};
   }
 
+#if !UNIFEX_NO_COROUTINES
+  // Awaiting the sender directly from a coroutine bypasses the generic
+  // sender/receiver adaptation. See io_awaiter.
+  io_awaiter operator co_await() && noexcept {
+    return io_awaiter{
+        context_, IORING_OP_READV, fd_, offset_, buffer_.data(), buffer_.size()};
+  }
+#endif
+
  private:
   io_uring_context& context_;
   int fd_;
@@ -613,6 +730,15 @@ class io_uring_context::write_sender {
     return operation<std::remove_cvref_t<Receiver>>{*this, (Receiver &&) r};
   }
 
+#if !UNIFEX_NO_COROUTINES
+  // Awaiting the sender directly from a coroutine bypasses the generic
+  // sender/receiver adaptation. See io_awaiter.
+  io_awaiter operator co_await() && noexcept {
+    return io_awaiter{
+        context_, IORING_OP_WRITEV, fd_, offset_, (void*)buffer_.data(), buffer_.size()};
+  }
+#endif
+
  private:
   io_uring_context& context_;
   int fd_;
@@ -16,12 +16,20 @@
 #pragma once
 
 #include <unifex/blocking.hpp>
+#include <unifex/detail/error_variant.hpp>
 #include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
+#include <unifex/unstoppable_token.hpp>
 
+#include <cassert>
 #include <condition_variable>
+#include <exception>
 #include <mutex>
+#include <optional>
 #include <type_traits>
 
 namespace unifex {
@@ -68,9 +76,19 @@ class _op<Receiver>::type final : task_base {
   context* const loop_;
 };
 
+template <typename T, typename ErrorVariant, typename StopToken>
+struct _sync_wait_promise {
+  class type;
+};
+template <typename T, typename ErrorVariant, typename StopToken>
+using sync_wait_promise =
+    typename _sync_wait_promise<T, ErrorVariant, StopToken>::type;
+
 class context {
   template <class Receiver>
   friend struct _op;
+  template <typename T, typename ErrorVariant, typename StopToken>
+  friend struct _sync_wait_promise;
  public:
   class scheduler {
     class schedule_task {
@@ -113,6 +131,14 @@ class context {
       return schedule_task{loop_};
     }
 
+    friend bool operator==(scheduler a, scheduler b) noexcept {
+      return a.loop_ == b.loop_;
+    }
+
+    friend bool operator!=(scheduler a, scheduler b) noexcept {
+      return a.loop_ != b.loop_;
+    }
+
    private:
     context* loop_;
   };
@@ -125,9 +151,40 @@ class context {
 
   void stop();
 
+  // Runs the event loop on the calling thread until 'sender' completes.
+  //
+  // The sender's receiver reports this loop as its scheduler, so work that
+  // is scheduled back onto it runs inline on the calling thread rather than
+  // needing another thread to call run(). Other threads may call run()
+  // concurrently. As the operation state lives on this thread's stack,
+  // sync_wait() does not return early if stop() is called.
+  template <
+      typename Sender,
+      typename StopToken = unstoppable_token,
+      typename Result = single_value_result_t<std::remove_cvref_t<Sender>>,
+      typename ErrorVariant =
+          detail::error_variant_t<std::remove_cvref_t<Sender>>>
+  std::optional<Result> sync_wait(Sender&& sender, StopToken st = {}) {
+    using promise_t = sync_wait_promise<Result, ErrorVariant, StopToken&&>;
+    promise_t promise{*this, (StopToken &&) st};
+
+    auto op = connect(std::move(sender), promise.get_receiver());
+    start(op);
+
+    run_until(promise.complete_);
+
+    return std::move(promise).get();
+  }
+
  private:
   void enqueue(task_base* task);
 
+  // Runs tasks until 'complete' is set by set_complete().
+  void run_until(const bool& complete);
+
+  // Sets 'complete' under the mutex and wakes run_until().
+  void set_complete(bool& complete);
+
   std::mutex mutex_;
   std::condition_variable cv_;
   task_base* head_ = nullptr;
@@ -140,6 +197,122 @@ inline void _op<Receiver>::type::start() noexcept {
   loop_->enqueue(this);
 }
 
+// The result of a context::sync_wait().
+//
+// The sender may complete on any thread. Its result is stored and a task is
+// enqueued onto the loop that marks the sync_wait() complete, so the loop's
+// mutex orders the result with the thread that reads it. As with
+// unifex::sync_wait(), errors are stored as the sender's declared error
+// types.
+template <typename T, typename ErrorVariant, typename StopToken>
+class _sync_wait_promise<T, ErrorVariant, StopToken>::type : task_base {
+  using sync_wait_promise = type;
+  enum class state { incomplete, done, value, error };
+
+  class receiver {
+   public:
+    template <typename... Values>
+    void set_value(Values&&... values) && noexcept {
+      try {
+        promise_.value_.construct(std::move(values)...);
+        promise_.state_ = state::value;
+      } catch (...) {
+        promise_.error_.construct(
+            std::in_place_type<std::exception_ptr>, std::current_exception());
+        promise_.state_ = state::error;
+      }
+      promise_.loop_.enqueue(&promise_);
+    }
+
+    template <typename Error>
+    void set_error(Error&& e) && noexcept {
+      detail::store_error(promise_.error_, (Error &&) e);
+      promise_.state_ = state::error;
+      promise_.loop_.enqueue(&promise_);
+    }
+
+    void set_done() && noexcept {
+      promise_.state_ = state::done;
+      promise_.loop_.enqueue(&promise_);
+    }
+
+    friend const StopToken& tag_invoke(
+        tag_t<get_stop_token>,
+        const receiver& r) noexcept {
+      return r.get_stop_token();
+    }
+
+    friend context::scheduler tag_invoke(
+        tag_t<get_scheduler>,
+        const receiver& r) noexcept {
+      return r.get_scheduler();
+    }
+
+   private:
+    friend sync_wait_promise;
+
+    StopToken& get_stop_token() const {
+      return promise_.stopToken_;
+    }
+
+    context::scheduler get_scheduler() const noexcept {
+      return promise_.loop_.get_scheduler();
+    }
+
+    explicit receiver(sync_wait_promise& promise) noexcept
+      : promise_(promise) {}
+
+    sync_wait_promise& promise_;
+  };
+
+ public:
+  explicit type(context& loop, StopToken&& stopToken) noexcept
+    : loop_(loop), stopToken_(std::move(stopToken)) {}
+
+  ~type() {
+    if (state_ == state::value) {
+      value_.destruct();
+    } else if (state_ == state::error) {
+      error_.destruct();
+    }
+  }
+
+  receiver get_receiver() noexcept {
+    return receiver{*this};
+  }
+
+  std::optional<T> get() && {
+    switch (state_) {
+      case state::done:
+        return std::nullopt;
+      case state::value:
+        return std::move(value_).get();
+      case state::error:
+        detail::throw_error(std::move(error_).get());
+      default:
+        assert(false);
+        std::terminate();
+    }
+  }
+
+ private:
+  friend context;
+
+  void execute() noexcept override {
+    loop_.set_complete(complete_);
+  }
+
+  union {
+    manual_lifetime<T> value_;
+    manual_lifetime<ErrorVariant> error_;
+  };
+
+  context& loop_;
+  state state_ = state::incomplete;
+  bool complete_ = false;
+  StopToken stopToken_;
+};
+
 } // namespace _manual_event_loop
 
 using manual_event_loop = _manual_event_loop::context;
@@ -0,0 +1,287 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/blocking.hpp>
+#include <unifex/config.hpp>
+#include <unifex/detail/fork_join.hpp>
+#include <unifex/detail/hardware_interference_size.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace unifex {
+namespace _par_reduce {
+
+template <typename Op, typename T>
+inline constexpr bool is_vectorizable_op_v =
+    std::is_same_v<Op, std::plus<T>> || std::is_same_v<Op, std::plus<>> ||
+    std::is_same_v<Op, std::multiplies<T>> ||
+    std::is_same_v<Op, std::multiplies<>>;
+
+template <typename Range, typename = void>
+struct contiguous_element {};
+
+template <typename Range>
+struct contiguous_element<
+    Range,
+    std::void_t<decltype(std::declval<Range&>().data())>> {
+  using type = std::remove_cv_t<
+      std::remove_pointer_t<decltype(std::declval<Range&>().data())>>;
+};
+
+// Whether chunks can be reduced with several independent accumulators,
+// which the compiler can keep in vector registers.
+template <typename Range, typename T, typename Op, typename = void>
+inline constexpr bool is_vectorizable_v = false;
+
+template <typename Range, typename T, typename Op>
+inline constexpr bool is_vectorizable_v<
+    Range,
+    T,
+    Op,
+    std::void_t<typename contiguous_element<Range>::type>> =
+    std::is_same_v<typename contiguous_element<Range>::type, T> &&
+    std::is_arithmetic_v<T> && is_vectorizable_op_v<Op, T>;
+
+template <
+    typename Range,
+    typename Scheduler,
+    typename T,
+    typename Op,
+    typename Receiver>
+struct _op {
+  class type;
+};
+template <
+    typename Range,
+    typename Scheduler,
+    typename T,
+    typename Op,
+    typename Receiver>
+using operation = typename _op<
+    Range,
+    Scheduler,
+    T,
+    Op,
+    std::remove_cvref_t<Receiver>>::type;
+
+// The range is split into chunks which are reduced concurrently on the
+// scheduler. Each chunk reduces into its own cache-line-sized slot, so
+// chunks share nothing while running. Once all of them have finished, the
+// partial results are combined pairwise in a tree, preserving the order of
+// the range.
+template <
+    typename Range,
+    typename Scheduler,
+    typename T,
+    typename Op,
+    typename Receiver>
+class _op<Range, Scheduler, T, Op, Receiver>::type
+  : public _fork_join::chunked_op_base<
+        typename _op<Range, Scheduler, T, Op, Receiver>::type,
+        Scheduler,
+        Receiver,
+        decltype(std::declval<Range&>().size())> {
+  using size_type = decltype(std::declval<Range&>().size());
+  using base =
+      _fork_join::chunked_op_base<type, Scheduler, Receiver, size_type>;
+  friend base;
+
+  struct alignas(hardware_destructive_interference_size) partial {
+    std::optional<T> value_;
+  };
+
+ public:
+  template <typename Receiver2>
+  explicit type(
+      Range&& range,
+      Scheduler&& scheduler,
+      T&& init,
+      Op&& op,
+      Receiver2&& receiver)
+    : range_((Range &&) range),
+      scheduler_((Scheduler &&) scheduler),
+      init_((T &&) init),
+      op_((Op &&) op),
+      receiver_((Receiver2 &&) receiver) {}
+
+  void start() & noexcept {
+    const size_type size = range_.size();
+    if (size == 0) {
+      unifex::set_value(std::move(receiver_), std::move(init_));
+      return;
+    }
+
+    const size_type chunkCount = base::chunk_count(size);
+    try {
+      partials_.reset(new partial[chunkCount]);
+    } catch (...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+      return;
+    }
+    this->fork_chunks(chunkCount);
+  }
+
+ private:
+  void run_chunk(size_type index) {
+    const size_type size = range_.size();
+    partials_[index].value_.emplace(reduce_chunk(
+        this->chunk_begin(size, index), this->chunk_begin(size, index + 1)));
+  }
+
+  // Reduces the non-empty chunk [begin, end) without using 'init_'.
+  T reduce_chunk(size_type begin, size_type end) {
+    if constexpr (is_vectorizable_v<Range, T, Op>) {
+      constexpr size_type lanes = 8;
+      const T* first = range_.data() + begin;
+      const size_type count = end - begin;
+      if (count >= lanes) {
+        T acc[lanes];
+        for (size_type lane = 0; lane < lanes; ++lane) {
+          acc[lane] = first[lane];
+        }
+        size_type idx = lanes;
+        for (; idx + lanes <= count; idx += lanes) {
+          for (size_type lane = 0; lane < lanes; ++lane) {
+            acc[lane] = op_(acc[lane], first[idx + lane]);
+          }
+        }
+        for (; idx < count; ++idx) {
+          acc[0] = op_(acc[0], first[idx]);
+        }
+        for (size_type width = lanes / 2; width > 0; width /= 2) {
+          for (size_type lane = 0; lane < width; ++lane) {
+            acc[lane] = op_(acc[lane], acc[lane + width]);
+          }
+        }
+        return acc[0];
+      }
+    }
+
+    auto first = range_.begin();
+    T result(first[begin]);
+    for (size_type idx = begin + 1; idx < end; ++idx) {
+      result = std::invoke(op_, std::move(result), first[idx]);
+    }
+    return result;
+  }
+
+  void join() {
+    const size_type chunkCount = this->chunkCount_;
+    for (size_type stride = 1; stride < chunkCount; stride *= 2) {
+      for (size_type i = 0; i + stride < chunkCount; i += 2 * stride) {
+        partials_[i].value_ = std::invoke(
+            op_,
+            std::move(*partials_[i].value_),
+            std::move(*partials_[i + stride].value_));
+      }
+    }
+    T result =
+        std::invoke(op_, std::move(init_), std::move(*partials_[0].value_));
+    partials_.reset();
+    unifex::set_value(std::move(receiver_), std::move(result));
+  }
+
+  UNIFEX_NO_UNIQUE_ADDRESS Range range_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+  T init_;
+  UNIFEX_NO_UNIQUE_ADDRESS Op op_;
+  UNIFEX_NO_UNIQUE_ADDRESS Receiver receiver_;
+  std::unique_ptr<partial[]> partials_;
+};
+
+template <typename Range, typename Scheduler, typename T, typename Op>
+struct _sender {
+  class type;
+};
+template <typename Range, typename Scheduler, typename T, typename Op>
+using sender = typename _sender<
+    std::decay_t<Range>,
+    std::decay_t<Scheduler>,
+    std::decay_t<T>,
+    std::decay_t<Op>>::type;
+
+template <typename Range, typename Scheduler, typename T, typename Op>
+class _sender<Range, Scheduler, T, Op>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<T>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  template <typename Range2, typename Scheduler2, typename T2, typename Op2>
+  explicit type(Range2&& range, Scheduler2&& scheduler, T2&& init, Op2&& op)
+    : range_((Range2 &&) range),
+      scheduler_((Scheduler2 &&) scheduler),
+      init_((T2 &&) init),
+      op_((Op2 &&) op) {}
+
+  template <typename Receiver>
+  operation<Range, Scheduler, T, Op, Receiver> connect(Receiver&& r) && {
+    return operation<Range, Scheduler, T, Op, Receiver>{
+        std::move(range_),
+        std::move(scheduler_),
+        std::move(init_),
+        std::move(op_),
+        (Receiver &&) r};
+  }
+
+ private:
+  friend blocking_kind tag_invoke(tag_t<blocking>, const type&) noexcept {
+    // May complete on one of the scheduler's threads.
+    return blocking_kind::maybe;
+  }
+
+  UNIFEX_NO_UNIQUE_ADDRESS Range range_;
+  UNIFEX_NO_UNIQUE_ADDRESS Scheduler scheduler_;
+  T init_;
+  UNIFEX_NO_UNIQUE_ADDRESS Op op_;
+};
+
+} // namespace _par_reduce
+
+namespace _par_reduce_cpo {
+  inline constexpr struct _fn {
+    template <typename Range, typename Scheduler, typename T, typename Op>
+    _par_reduce::sender<Range, Scheduler, T, Op> operator()(
+        Range&& range,
+        Scheduler&& scheduler,
+        T&& init,
+        Op&& op) const {
+      return _par_reduce::sender<Range, Scheduler, T, Op>{
+          (Range &&) range,
+          (Scheduler &&) scheduler,
+          (T &&) init,
+          (Op &&) op};
+    }
+  } parallel_reduce{};
+} // namespace _par_reduce_cpo
+
+using _par_reduce_cpo::parallel_reduce;
+
+} // namespace unifex
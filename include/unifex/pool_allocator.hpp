@@ -0,0 +1,116 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/memory_resource.hpp>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace unifex {
+namespace _pool {
+  // A process-wide, size-class based pool intended for short-lived
+  // operation-states (eg. those allocated by submit() or allocate()).
+  //
+  // Each thread has its own cache of free blocks per size-class that it
+  // allocates from and frees to without any synchronisation. Blocks freed
+  // by a thread other than the one that allocated them are collected into
+  // small batches that are handed back to the owning thread with a single
+  // atomic operation.
+  //
+  // Requests larger than max_pooled_size or with an alignment stricter than
+  // max_pooled_alignment are forwarded to the global operator new/delete.
+  //
+  // Memory obtained for pooled blocks is retained by the pool for reuse
+  // and is not returned to the system.
+  inline constexpr std::size_t max_pooled_size = 2048;
+  inline constexpr std::size_t max_pooled_alignment =
+      alignof(std::max_align_t);
+
+  [[nodiscard]] void* allocate(std::size_t bytes, std::size_t alignment);
+  void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept;
+
+  template <typename T>
+  class allocator {
+  public:
+    using value_type = T;
+
+    allocator() noexcept = default;
+
+    template <typename U>
+    allocator(const allocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+      if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+        throw std::bad_array_new_length{};
+      }
+      return static_cast<T*>(_pool::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+      _pool::deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    friend bool operator==(const allocator&, const allocator<U>&) noexcept {
+      return true;
+    }
+
+    template <typename U>
+    friend bool operator!=(const allocator&, const allocator<U>&) noexcept {
+      return false;
+    }
+  };
+
+#if !UNIFEX_NO_MEMORY_RESOURCE
+  class resource final : public pmr::memory_resource {
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+      return _pool::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+        override {
+      _pool::deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const
+        noexcept override {
+      // All instances share the same process-wide pool.
+      return dynamic_cast<const resource*>(&other) != nullptr;
+    }
+  };
+#endif
+} // namespace _pool
+
+// A stateless allocator that allocates from the process-wide operation-state
+// pool. Usable anywhere an allocator is queried with get_allocator(), eg.
+//
+//   submit(with_allocator(sender, pool_allocator<std::byte>{}), receiver);
+template <typename T = std::byte>
+using pool_allocator = _pool::allocator<T>;
+
+#if !UNIFEX_NO_MEMORY_RESOURCE
+// Returns a pointer to a memory_resource that allocates from the
+// process-wide operation-state pool.
+inline pmr::memory_resource* pool_memory_resource() noexcept {
+  static _pool::resource instance;
+  return &instance;
+}
+#endif
+
+} // namespace unifex
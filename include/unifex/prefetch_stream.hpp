@@ -0,0 +1,228 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/buffered_stream.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace unifex {
+namespace _prefetch {
+
+using _buffered::waiter_base;
+
+template <typename Stream>
+struct _state {
+  class type;
+};
+template <typename Stream>
+using state = typename _state<Stream>::type;
+
+// The state shared by the prefetching stream and its operations.
+//
+// At most one next() on the source stream is in flight at a time. It is
+// restarted whenever it completes, until the buffer of prefetched values is
+// full, the source stream ends, or cleanup() is called.
+template <typename Stream>
+class _state<Stream>::type : public _buffered::state_base<type, Stream> {
+  using base = _buffered::state_base<type, Stream>;
+  friend base;
+  template <typename State>
+  friend struct _buffered::_fetch_receiver;
+
+  using base::consumer_;
+  using base::fetching_;
+  using base::mutex_;
+  using base::stopping_;
+
+ public:
+  using value_type = typename next_sender_t<Stream>::template value_types<
+      std::variant,
+      decayed_tuple<std::tuple>::template apply>;
+
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = typename next_sender_t<Stream>::template value_types<
+      Variant,
+      decayed_tuple<Tuple>::template apply>;
+
+  template <typename Stream2>
+  explicit type(Stream2&& stream, std::size_t capacity)
+    : base((Stream2 &&) stream),
+      buffer_(new std::optional<value_type>[capacity]),
+      capacity_(capacity) {
+    assert(capacity > 0);
+  }
+
+  // Tries to take the next prefetched result for the consumer.
+  //
+  // If none is available yet then 'waiter' is parked until one is and
+  // 'false' is returned. Otherwise, exactly one of 'value', 'error' or
+  // neither (for end-of-stream) is filled in and 'true' is returned.
+  bool try_take(
+      waiter_base* waiter,
+      std::optional<value_type>& value,
+      std::exception_ptr& error) noexcept {
+    std::unique_lock lock{mutex_};
+    bool result = true;
+    if (size_ > 0) {
+      value = std::move(buffer_[head_]);
+      buffer_[head_].reset();
+      head_ = (head_ + 1) % capacity_;
+      --size_;
+    } else if (error_) {
+      error = std::exchange(error_, nullptr);
+    } else if (!sourceDone_) {
+      consumer_ = waiter;
+      result = false;
+    }
+    bool shouldFetch = start_fetching();
+    lock.unlock();
+
+    if (shouldFetch) {
+      this->fetch();
+    }
+    return result;
+  }
+
+  template <typename Receiver>
+  static void deliver_value(Receiver&& receiver, value_type&& value) noexcept {
+    std::visit(
+        [&](auto&& tuple) {
+          std::apply(
+              [&](auto&&... values) {
+                unifex::set_value(
+                    (Receiver &&) receiver, std::move(values)...);
+              },
+              std::move(tuple));
+        },
+        std::move(value));
+  }
+
+ private:
+  // Must be called with the mutex held.
+  bool start_fetching() noexcept {
+    if (fetching_ || stopping_ || sourceDone_ || error_ ||
+        size_ == capacity_) {
+      return false;
+    }
+    fetching_ = true;
+    return true;
+  }
+
+  // Must be called with the mutex held.
+  void discard() noexcept {
+    for (; size_ > 0; --size_) {
+      buffer_[head_].reset();
+      head_ = (head_ + 1) % capacity_;
+    }
+  }
+
+  // Must be called with the mutex held.
+  bool in_flight() const noexcept {
+    return fetching_;
+  }
+
+  template <typename... Values>
+  void fetch_value(Values&&... values) noexcept {
+    std::optional<value_type> value;
+    std::exception_ptr error;
+    try {
+      value.emplace(
+          std::in_place_type<std::tuple<std::remove_cvref_t<Values>...>>,
+          (Values &&) values...);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    this->destroy_fetch();
+    finish_fetch(std::move(value), std::move(error));
+  }
+
+  void end_fetch(std::exception_ptr error) noexcept {
+    finish_fetch(std::nullopt, std::move(error));
+  }
+
+  void finish_fetch(
+      std::optional<value_type> value,
+      std::exception_ptr error) noexcept {
+    std::unique_lock lock{mutex_};
+    fetching_ = false;
+    if (stopping_) {
+      this->stopped(std::move(lock));
+      return;
+    }
+
+    if (value.has_value()) {
+      buffer_[(head_ + size_) % capacity_] = std::move(value);
+      ++size_;
+    } else {
+      sourceDone_ = true;
+      error_ = std::move(error);
+    }
+    waiter_base* consumer = std::exchange(consumer_, nullptr);
+    bool shouldFetch = start_fetching();
+    lock.unlock();
+
+    if (shouldFetch) {
+      this->fetch();
+    }
+    this->resume(consumer);
+  }
+
+  // Ring buffer of prefetched values.
+  const std::unique_ptr<std::optional<value_type>[]> buffer_;
+  const std::size_t capacity_;
+  std::size_t head_ = 0;
+  std::size_t size_ = 0;
+  bool sourceDone_ = false;
+  std::exception_ptr error_;
+};
+
+template <typename Stream>
+using stream = _buffered::stream<state<std::remove_cvref_t<Stream>>>;
+
+} // namespace _prefetch
+
+namespace _prefetch_cpo {
+  inline constexpr struct _fn {
+    template <typename Stream>
+    _prefetch::stream<Stream>
+    operator()(Stream&& stream, std::size_t count) const {
+      using state_t = _prefetch::state<std::remove_cvref_t<Stream>>;
+      return _prefetch::stream<Stream>{
+          std::make_unique<state_t>((Stream &&) stream, count)};
+    }
+  } prefetch_stream{};
+} // namespace _prefetch_cpo
+
+using _prefetch_cpo::prefetch_stream;
+
+} // namespace unifex
@@ -172,26 +172,37 @@ struct _next_receiver<Operation>::type {
   }
 
   template <typename... Values>
-  void set_value(Values... values) && noexcept {
+  void set_value(Values&&... values) && noexcept {
     auto& op = op_;
-    op.next_.destruct();
+    std::exception_ptr ex;
     try {
+      // Values may refer into the stream (eg. a generator's frame) or into
+      // the next() operation, so it is only destroyed once they are reduced.
       op.state_ = std::invoke(
           op.reducer_,
           std::forward<state_type>(op.state_),
-          std::move(values)...);
-      op.next_.construct_from([&]() {
-        return unifex::connect(next(op.stream_), _reduce::next_receiver<Operation>{op});
-      });
-      unifex::start(op.next_.get());
+          (Values &&) values...);
     } catch (...) {
-      op.errorCleanup_.construct_from([&] {
-        return unifex::connect(
-            cleanup(op.stream_),
-            error_cleanup_receiver<Operation>{op, std::current_exception()});
-      });
-      unifex::start(op.errorCleanup_.get());
+      ex = std::current_exception();
+    }
+    op.next_.destruct();
+    if (!ex) {
+      try {
+        op.next_.construct_from([&]() {
+          return unifex::connect(next(op.stream_), _reduce::next_receiver<Operation>{op});
+        });
+        unifex::start(op.next_.get());
+        return;
+      } catch (...) {
+        ex = std::current_exception();
+      }
     }
+    op.errorCleanup_.construct_from([&] {
+      return unifex::connect(
+          cleanup(op.stream_),
+          error_cleanup_receiver<Operation>{op, std::move(ex)});
+    });
+    unifex::start(op.errorCleanup_.get());
   }
 
   void set_done() && noexcept {
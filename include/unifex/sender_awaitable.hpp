@@ -20,6 +20,7 @@
 #include <unifex/unstoppable_token.hpp>
 #include <unifex/async_trace.hpp>
 #include <unifex/coroutine.hpp>
+#include <unifex/detail/error_variant.hpp>
 
 #if UNIFEX_NO_COROUTINES
 #error                                                                         \
@@ -54,7 +55,9 @@ struct _sender_awaiter<Sender, Value>::type {
             awaiter_.value_.construct(std::move(values)...);
             awaiter_.state_ = state::value;
         } catch (...) {
-            awaiter_.ex_.construct(std::current_exception());
+            awaiter_.error_.construct(
+                std::in_place_type<std::exception_ptr>,
+                std::current_exception());
             awaiter_.state_ = state::error;
         }
       }
@@ -63,11 +66,7 @@ struct _sender_awaiter<Sender, Value>::type {
 
     template<typename Error>
     void set_error(Error&& error) && noexcept {
-      std::move(*this).set_error(std::make_exception_ptr(std::move(error)));
-    }
-
-    void set_error(std::exception_ptr ex) && noexcept {
-      awaiter_.ex_.construct(std::move(ex));
+      detail::store_error(awaiter_.error_, (Error &&) error);
       awaiter_.state_ = state::error;
       awaiter_.continuation_.resume();
     }
@@ -97,7 +96,7 @@ struct _sender_awaiter<Sender, Value>::type {
   ~type() {
     switch (state_) {
       case state::value: value_.destruct(); break;
-      case state::error: ex_.destruct(); break;
+      case state::error: error_.destruct(); break;
       default: break;
     }
   }
@@ -132,10 +131,14 @@ struct _sender_awaiter<Sender, Value>::type {
         }
     }
     assert(state_ == state::error);
-    std::rethrow_exception(std::move(ex_.get()));
+    // Declared errors such as std::error_code are thrown directly rather
+    // than round-tripping through std::exception_ptr.
+    detail::throw_error(std::move(error_).get());
   }
 
-private:
+protected:
+  using error_variant =
+      detail::error_variant_t<std::remove_reference_t<Sender>>;
 
   enum class state {
     empty,
@@ -149,17 +152,51 @@ private:
   coro::coroutine_handle<> continuation_;
   union {
     manual_lifetime<Value> value_;
-    manual_lifetime<std::exception_ptr> ex_;
+    manual_lifetime<error_variant> error_;
   };
   std::optional<continuation_info> info_;
 };
+
+template <typename Sender, typename Result>
+struct _or_error_awaiter {
+  struct type;
+};
+template <typename Sender, typename Result>
+using or_error_awaiter = typename _or_error_awaiter<Sender, Result>::type;
+
+// Resumes with the sender's result or error as a value rather than throwing
+// the error, so that a declared error such as std::error_code is reported
+// without allocating.
+template <typename Sender, typename Result>
+struct _or_error_awaiter<Sender, Result>::type
+  : sender_awaiter<Sender, Result> {
+  using base = sender_awaiter<Sender, Result>;
+  using result_type =
+      detail::or_error_t<Result, typename base::error_variant>;
+
+  using base::base;
+
+  result_type await_resume() {
+    switch (this->state_) {
+      case base::state::value:
+        return result_type{
+            std::in_place_index<0>, std::move(this->value_).get()};
+      case base::state::done:
+        return result_type{std::in_place_index<0>};
+      default:
+        assert(this->state_ == base::state::error);
+        return detail::to_or_error<result_type>(
+            std::move(this->error_).get());
+    }
+  }
+};
 } // namespace _coroutine
 
 template<
   typename Sender,
   typename Result = single_value_result_t<std::remove_reference_t<Sender>>>
 auto operator co_await(Sender&& sender) {
-  return _coroutine::sender_awaiter<Sender, Result>{std::move(sender});
+  return _coroutine::sender_awaiter<Sender, Result>{std::move(sender)};
 }
 
 template<
@@ -172,4 +209,14 @@ auto operator co_await(Sender&& sender) {
   return _coroutine::sender_awaiter<Sender, void>{std::move(sender)};
 }
 
+// As co_await on 'sender', but resumes with
+// std::variant<std::optional<Result>, Errors...> instead of throwing the
+// sender's error. See sync_wait_or_error().
+template<
+  typename Sender,
+  typename Result = single_value_result_t<std::remove_reference_t<Sender>>>
+auto await_or_error(Sender&& sender) {
+  return _coroutine::or_error_awaiter<Sender, Result>{std::move(sender)};
+}
+
 }
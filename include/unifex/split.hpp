@@ -0,0 +1,288 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/blocking.hpp>
+#include <unifex/detail/intrusive_queue.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+namespace unifex {
+namespace _split {
+
+struct waiter_base {
+  void (*complete_)(waiter_base*) noexcept;
+  waiter_base* next_;
+};
+
+template <typename Sender>
+struct _state {
+  class type;
+};
+template <typename Sender>
+using state = typename _state<Sender>::type;
+
+template <typename Sender>
+struct _receiver {
+  class type;
+};
+template <typename Sender>
+using receiver = typename _receiver<Sender>::type;
+
+template <typename Sender>
+class _receiver<Sender>::type {
+ public:
+  explicit type(state<Sender>& s) noexcept : state_(s) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) noexcept {
+    try {
+      state_.values_.emplace(
+          std::in_place_type<std::tuple<std::decay_t<Values>...>>,
+          (Values &&) values...);
+    } catch (...) {
+      state_.error_.emplace(std::current_exception());
+    }
+    state_.complete();
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    state_.error_.emplace(
+        std::in_place_type<std::decay_t<Error>>, (Error &&) error);
+    state_.complete();
+  }
+
+  void set_done() noexcept {
+    state_.complete();
+  }
+
+ private:
+  state<Sender>& state_;
+};
+
+template <template <typename...> class Variant, typename Sender>
+using error_types = typename concat_type_lists_unique_t<
+    typename Sender::template error_types<type_list>,
+    type_list<std::exception_ptr>>::template apply<Variant>;
+
+// The state shared by all copies of a split() sender.
+//
+// The predecessor is connected up-front and started by the first
+// subscriber. Subscribers that arrive before it completes are pushed onto a
+// lock-free intrusive stack; those that arrive afterwards complete inline.
+//
+// Subscribers cannot be cancelled. Their stop-tokens are ignored: a waiter
+// cannot be unlinked from the middle of the lock-free stack. The predecessor
+// is run with an unstoppable_token, as no single subscriber owns it. A
+// subscriber whose stop-token is triggered therefore still waits for the
+// predecessor to complete and receives its result.
+template <typename Sender>
+class _state<Sender>::type {
+  template <typename Sender2>
+  friend struct _receiver;
+
+ public:
+  explicit type(Sender&& sender)
+    : predOp_(connect(std::move(sender), receiver<Sender>{*this})) {}
+
+  type(type&&) = delete;
+
+  // Completes 'waiter' inline if the predecessor has already completed,
+  // otherwise enqueues it, starting the predecessor if it is the first.
+  static void
+  subscribe(const std::shared_ptr<type>& self, waiter_base* waiter) noexcept {
+    void* const completed = self->completed_value();
+    void* oldValue = self->head_.load(std::memory_order_acquire);
+    do {
+      if (oldValue == completed) {
+        waiter->complete_(waiter);
+        return;
+      }
+      waiter->next_ = static_cast<waiter_base*>(oldValue);
+    } while (!self->head_.compare_exchange_weak(
+        oldValue,
+        waiter,
+        std::memory_order_acq_rel,
+        std::memory_order_acquire));
+
+    if (oldValue == nullptr) {
+      // Keep the state alive until the predecessor completes, even if
+      // every sender and subscriber is destroyed before then.
+      self->self_ = self;
+      unifex::start(self->predOp_);
+    }
+  }
+
+  // Sends each subscriber its own copy of the result.
+  template <typename Receiver>
+  void deliver(Receiver& r) const noexcept {
+    try {
+      if (values_.has_value()) {
+        std::visit(
+            [&](const auto& values) {
+              std::apply(
+                  [&](auto&&... copies) {
+                    unifex::set_value(std::move(r), std::move(copies)...);
+                  },
+                  std::remove_cvref_t<decltype(values)>{values});
+            },
+            *values_);
+      } else if (error_.has_value()) {
+        std::visit(
+            [&](const auto& error) {
+              unifex::set_error(
+                  std::move(r), std::remove_cvref_t<decltype(error)>{error});
+            },
+            *error_);
+      } else {
+        unifex::set_done(std::move(r));
+      }
+    } catch (...) {
+      unifex::set_error(std::move(r), std::current_exception());
+    }
+  }
+
+ private:
+  void complete() noexcept {
+    // Released once all waiters have been notified.
+    auto self = std::move(self_);
+
+    void* waiters =
+        head_.exchange(completed_value(), std::memory_order_acq_rel);
+    auto queue =
+        intrusive_queue<waiter_base, &waiter_base::next_>::make_reversed(
+            static_cast<waiter_base*>(waiters));
+    while (!queue.empty()) {
+      waiter_base* waiter = queue.pop_front();
+      waiter->complete_(waiter);
+    }
+  }
+
+  void* completed_value() const noexcept {
+    // Pick some pointer that is not nullptr and that is
+    // guaranteed to not be the address of a valid waiter.
+    return const_cast<void*>(static_cast<const void*>(&head_));
+  }
+
+  std::optional<typename Sender::template value_types<
+      std::variant,
+      decayed_tuple<std::tuple>::template apply>>
+      values_;
+  std::optional<error_types<std::variant, Sender>> error_;
+  // nullptr if not yet started, completed_value() once complete, otherwise
+  // the most recently enqueued waiter.
+  std::atomic<void*> head_{nullptr};
+  std::shared_ptr<type> self_;
+  operation_t<Sender, receiver<Sender>> predOp_;
+};
+
+template <typename Sender, typename Receiver>
+struct _op {
+  class type;
+};
+template <typename Sender, typename Receiver>
+using operation = typename _op<Sender, std::remove_cvref_t<Receiver>>::type;
+
+template <typename Sender, typename Receiver>
+class _op<Sender, Receiver>::type : waiter_base {
+ public:
+  template <typename Receiver2>
+  explicit type(std::shared_ptr<state<Sender>> s, Receiver2&& r)
+    : state_(std::move(s)), receiver_((Receiver2 &&) r) {
+    this->complete_ = [](waiter_base* self) noexcept {
+      type& op = *static_cast<type*>(self);
+      op.state_->deliver(op.receiver_);
+    };
+  }
+
+  type(type&&) = delete;
+
+  void start() noexcept {
+    state<Sender>::subscribe(state_, this);
+  }
+
+ private:
+  std::shared_ptr<state<Sender>> state_;
+  Receiver receiver_;
+};
+
+template <typename Sender>
+struct _sender {
+  class type;
+};
+template <typename Sender>
+using sender = typename _sender<std::remove_cvref_t<Sender>>::type;
+
+template <typename Sender>
+class _sender<Sender>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = typename Sender::template value_types<
+      Variant,
+      decayed_tuple<Tuple>::template apply>;
+
+  template <template <typename...> class Variant>
+  using error_types = _split::error_types<Variant, Sender>;
+
+  explicit type(Sender sender)
+    : state_(std::make_shared<state<Sender>>(std::move(sender))) {}
+
+  template <typename Receiver>
+  operation<Sender, Receiver> connect(Receiver&& r) const& {
+    return operation<Sender, Receiver>{state_, (Receiver &&) r};
+  }
+
+  template <typename Receiver>
+  operation<Sender, Receiver> connect(Receiver&& r) && {
+    return operation<Sender, Receiver>{std::move(state_), (Receiver &&) r};
+  }
+
+ private:
+  friend blocking_kind tag_invoke(tag_t<blocking>, const type&) noexcept {
+    return blocking_kind::maybe;
+  }
+
+  std::shared_ptr<state<Sender>> state_;
+};
+
+} // namespace _split
+
+namespace _split_cpo {
+  inline constexpr struct _fn {
+    template <typename Sender>
+    _split::sender<Sender> operator()(Sender&& sender) const {
+      return _split::sender<Sender>{(Sender &&) sender};
+    }
+  } split{};
+} // namespace _split_cpo
+
+using _split_cpo::split;
+
+} // namespace unifex
@@ -15,11 +15,14 @@
  */
 #pragma once
 
+#include <unifex/arena_resource.hpp>
+#include <unifex/get_allocator.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
+#include <unifex/detail/hardware_interference_size.hpp>
 #include <unifex/detail/intrusive_queue.hpp>
 
 #include <thread>
@@ -43,6 +46,9 @@ namespace _static_thread_pool {
   template <typename Receiver>
   using operation = typename _op<std::remove_cvref_t<Receiver>>::type;
 
+  template <typename T>
+  class allocator;
+
   class context {
     template <typename Receiver>
     friend struct _op;
@@ -93,6 +99,19 @@ namespace _static_thread_pool {
         return s.make_sender_();
       }
 
+      // Returns an allocator that allocates from the arena of the pool's
+      // worker thread that is calling allocate().
+      friend allocator<std::byte>
+      tag_invoke(tag_t<get_allocator>, const scheduler& s) noexcept;
+
+      friend bool operator==(const scheduler& a, const scheduler& b) noexcept {
+        return &a.pool_ == &b.pool_;
+      }
+
+      friend bool operator!=(const scheduler& a, const scheduler& b) noexcept {
+        return &a.pool_ != &b.pool_;
+      }
+
       friend class context;
       explicit scheduler(context& pool) noexcept : pool_(pool) {}
 
@@ -104,7 +123,21 @@ namespace _static_thread_pool {
     void request_stop() noexcept;
 
   private:
-    class thread_state {
+    template <typename T>
+    friend class allocator;
+
+    // Allocate from the calling worker thread's arena, or from a shared
+    // arena if called from a thread that is not one of this pool's workers.
+    void* allocate(std::size_t bytes, std::size_t alignment);
+
+    // Each worker's queue is hit by its own thread on every iteration of
+    // run() and by other threads when enqueueing or stealing. Align each
+    // state to its own cache-line(s) so that adjacent workers in
+    // threadStates_ don't bounce lines between cores.
+    //
+    // Note that std::allocator supports over-aligned types, so the
+    // std::vector below allocates correctly aligned storage.
+    class alignas(hardware_destructive_interference_size) thread_state {
     public:
       task_base* try_pop();
       task_base* pop();
@@ -112,6 +145,9 @@ namespace _static_thread_pool {
       void push(task_base* task);
       void request_stop();
 
+      // Only allocated from by the thread running this worker.
+      arena_resource arena_;
+
     private:
       std::mutex mut_;
       std::condition_variable cv_;
@@ -124,12 +160,67 @@ namespace _static_thread_pool {
 
     void enqueue(task_base* task) noexcept;
 
+    std::mutex sharedArenaMutex_;
+    arena_resource sharedArena_;
+
     std::uint32_t threadCount_;
     std::vector<std::thread> threads_;
     std::vector<thread_state> threadStates_;
-    std::atomic<std::uint32_t> nextThread_;
+
+    // Written by every call to enqueue() so keep it off the cache-line
+    // holding the read-mostly members above.
+    alignas(hardware_destructive_interference_size)
+        std::atomic<std::uint32_t> nextThread_;
   };
 
+  // Allocates operation-states from per-worker arenas of a
+  // static_thread_pool. Memory may be deallocated from any thread.
+  //
+  // Obtain one by calling get_allocator() on the pool's scheduler and
+  // inject it with with_allocator().
+  template <typename T>
+  class allocator {
+  public:
+    using value_type = T;
+
+    explicit allocator(context& pool) noexcept : pool_(&pool) {}
+
+    template <typename U>
+    allocator(const allocator<U>& other) noexcept : pool_(other.pool_) {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+      if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+        throw std::bad_array_new_length{};
+      }
+      return static_cast<T*>(pool_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+      arena_resource::deallocate(p);
+    }
+
+    template <typename U>
+    friend bool operator==(const allocator& a, const allocator<U>& b) noexcept {
+      return a.pool_ == b.pool_;
+    }
+
+    template <typename U>
+    friend bool operator!=(const allocator& a, const allocator<U>& b) noexcept {
+      return a.pool_ != b.pool_;
+    }
+
+  private:
+    template <typename U>
+    friend class allocator;
+
+    context* pool_;
+  };
+
+  inline allocator<std::byte>
+  tag_invoke(tag_t<get_allocator>, const context::scheduler& s) noexcept {
+    return allocator<std::byte>{s.pool_};
+  }
+
   template <typename Receiver>
   class _op<Receiver>::type : task_base {
     friend context::scheduler::schedule_sender;
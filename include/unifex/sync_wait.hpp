@@ -20,79 +20,130 @@
 #include <unifex/unstoppable_token.hpp>
 #include <unifex/blocking.hpp>
 #include <unifex/get_stop_token.hpp>
+#include <unifex/spin_wait.hpp>
+#include <unifex/detail/error_variant.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <exception>
 #include <mutex>
 #include <type_traits>
 #include <utility>
 #include <optional>
+#include <variant>
 #include <cassert>
 
 namespace unifex {
 namespace _sync_wait {
 
-template <typename T>
+enum class state { incomplete, waiting, done, value, error };
+
+// The result of a sync_wait() whose sender may complete on another thread.
+//
+// Completion costs a single atomic exchange, plus a wake-up if the waiting
+// thread has already blocked. Where std::atomic::wait() is unavailable this
+// falls back to a mutex and condition variable.
+template <typename T, typename ErrorVariant>
 struct promise {
   promise() {}
 
   ~promise() {
-    if (state_ == state::value) {
+    const state s = state_.load(std::memory_order_relaxed);
+    if (s == state::value) {
       value_.destruct();
-    } else if (state_ == state::error) {
-      exception_.destruct();
+    } else if (s == state::error) {
+      error_.destruct();
     }
   }
 
-  std::mutex mutex_;
-  std::condition_variable cv_;
+  // Publishes the result, which must already have been constructed.
+  void complete(state s) noexcept {
+#if defined(__cpp_lib_atomic_wait)
+    if (state_.exchange(s, std::memory_order_acq_rel) == state::waiting) {
+      state_.notify_one();
+      // Tell wait() that this thread no longer accesses the promise.
+      notified_.store(true, std::memory_order_release);
+    }
+#else
+    std::lock_guard lock{mutex_};
+    state_.store(s, std::memory_order_relaxed);
+    cv_.notify_one();
+#endif
+  }
+
+  // Blocks until complete() has been called and returns the final state.
+  state wait() noexcept {
+#if defined(__cpp_lib_atomic_wait)
+    state s = state::incomplete;
+    if (state_.compare_exchange_strong(
+            s,
+            state::waiting,
+            std::memory_order_acquire,
+            std::memory_order_acquire)) {
+      do {
+        state_.wait(state::waiting, std::memory_order_acquire);
+        s = state_.load(std::memory_order_acquire);
+      } while (s == state::waiting);
+
+      // The completing thread may still be inside notify_one().
+      spin_wait spin;
+      while (!notified_.load(std::memory_order_acquire)) {
+        spin.wait();
+      }
+    }
+    return s;
+#else
+    std::unique_lock lock{mutex_};
+    cv_.wait(lock, [&] {
+      return state_.load(std::memory_order_relaxed) != state::incomplete;
+    });
+    return state_.load(std::memory_order_relaxed);
+#endif
+  }
+
   union {
     manual_lifetime<T> value_;
-    manual_lifetime<std::exception_ptr> exception_;
+    manual_lifetime<ErrorVariant> error_;
   };
 
-  enum class state { incomplete, done, value, error };
-  state state_ = state::incomplete;
+  std::atomic<state> state_{state::incomplete};
+#if defined(__cpp_lib_atomic_wait)
+  std::atomic<bool> notified_{false};
+#else
+  std::mutex mutex_;
+  std::condition_variable cv_;
+#endif
 };
 
-template <typename T, typename StopToken>
+template <typename T, typename ErrorVariant, typename StopToken>
 struct _receiver {
   struct type {
     using receiver = type;
 
-    promise<T>& promise_;
+    promise<T, ErrorVariant>& promise_;
     StopToken stopToken_;
 
     template <typename... Values>
     void set_value(Values&&... values) && noexcept {
-      std::lock_guard lock{ promise_.mutex_ };
       try {
         promise_.value_.construct(std::move(values)...);
-        promise_.state_ = promise<T>::state::value;
+        promise_.complete(state::value);
       }
       catch (...) {
-        promise_.exception_.construct(std::current_exception());
-        promise_.state_ = promise<T>::state::error;
+        promise_.error_.construct(
+            std::in_place_type<std::exception_ptr>, std::current_exception());
+        promise_.complete(state::error);
       }
-      promise_.cv_.notify_one();
-    }
-
-    void set_error(std::exception_ptr err) && noexcept {
-      std::lock_guard lock{ promise_.mutex_ };
-      promise_.exception_.construct(std::move(err));
-      promise_.state_ = promise<T>::state::error;
-      promise_.cv_.notify_one();
     }
 
     template <typename Error>
     void set_error(Error&& e) && noexcept {
-      std::move(*this).set_error(std::make_exception_ptr(std::move(e)));
+      detail::store_error(promise_.error_, (Error &&) e);
+      promise_.complete(state::error);
     }
 
     void set_done() && noexcept {
-      std::lock_guard lock{ promise_.mutex_ };
-      promise_.state_ = promise<T>::state::done;
-      promise_.cv_.notify_one();
+      promise_.complete(state::done);
     }
 
     friend const StopToken& tag_invoke(
@@ -102,10 +153,10 @@ struct _receiver {
   };
 };
 
-template <typename T, typename StopToken>
-using receiver = typename _receiver<T, StopToken>::type;
+template <typename T, typename ErrorVariant, typename StopToken>
+using receiver = typename _receiver<T, ErrorVariant, StopToken>::type;
 
-template<typename T>
+template<typename T, typename ErrorVariant>
 struct thread_unsafe_promise {
   thread_unsafe_promise() noexcept {}
 
@@ -113,51 +164,47 @@ struct thread_unsafe_promise {
     if (state_ == state::value) {
       value_.destruct();
     } else if (state_ == state::error) {
-      exception_.destruct();
+      error_.destruct();
     }
   }
 
   union {
     manual_lifetime<T> value_;
-    manual_lifetime<std::exception_ptr> exception_;
+    manual_lifetime<ErrorVariant> error_;
   };
 
-  enum class state { incomplete, done, value, error };
   state state_ = state::incomplete;
 };
 
-template<typename T, typename StopToken>
+template<typename T, typename ErrorVariant, typename StopToken>
 struct _thread_unsafe_receiver {
   struct type {
     using thread_unsafe_receiver = type;
 
-    thread_unsafe_promise<T>& promise_;
+    thread_unsafe_promise<T, ErrorVariant>& promise_;
     StopToken stopToken_;
 
     template <typename... Values>
     void set_value(Values&&... values) && noexcept {
       try {
         promise_.value_.construct(std::move(values)...);
-        promise_.state_ = thread_unsafe_promise<T>::state::value;
+        promise_.state_ = state::value;
       }
       catch (...) {
-        promise_.exception_.construct(std::current_exception());
-        promise_.state_ = thread_unsafe_promise<T>::state::error;
+        promise_.error_.construct(
+            std::in_place_type<std::exception_ptr>, std::current_exception());
+        promise_.state_ = state::error;
       }
     }
 
-    void set_error(std::exception_ptr err) && noexcept {
-      promise_.exception_.construct(std::move(err));
-      promise_.state_ = thread_unsafe_promise<T>::state::error;
-    }
-
     template <typename Error>
     void set_error(Error&& e) && noexcept {
-      std::move(*this).set_error(std::make_exception_ptr(std::move(e)));
+      detail::store_error(promise_.error_, (Error &&) e);
+      promise_.state_ = state::error;
     }
 
     void set_done() && noexcept {
-      promise_.state_ = thread_unsafe_promise<T>::state::done;
+      promise_.state_ = state::done;
     }
 
     friend const StopToken& tag_invoke(
@@ -167,8 +214,48 @@ struct _thread_unsafe_receiver {
   };
 };
 
-template<typename T, typename StopToken>
-using thread_unsafe_receiver = typename _thread_unsafe_receiver<T, StopToken>::type;
+template<typename T, typename ErrorVariant, typename StopToken>
+using thread_unsafe_receiver =
+    typename _thread_unsafe_receiver<T, ErrorVariant, StopToken>::type;
+
+// Runs 'sender' to completion and passes the final state, along with the
+// promise holding the result, to 'fn'.
+template <
+    typename Result,
+    typename ErrorVariant,
+    typename Sender,
+    typename StopToken,
+    typename Fn>
+decltype(auto) wait(Sender&& sender, StopToken&& stopToken, Fn&& fn) {
+  auto blockingResult = blocking(sender);
+  if (blockingResult == blocking_kind::always ||
+      blockingResult == blocking_kind::always_inline) {
+    thread_unsafe_promise<Result, ErrorVariant> promise;
+
+    auto operation = connect(
+      std::move(sender),
+      thread_unsafe_receiver<Result, ErrorVariant, StopToken&&>{
+        promise, std::move(stopToken)});
+
+    start(operation);
+
+    assert(promise.state_ != state::incomplete);
+
+    return std::move(fn)(promise.state_, promise);
+  } else {
+    promise<Result, ErrorVariant> promise;
+
+    // Store state for the operation on the stack.
+    auto operation = connect(
+        std::move(sender),
+        receiver<Result, ErrorVariant, StopToken&&>{
+          promise, std::move(stopToken)});
+
+    start(operation);
+
+    return std::move(fn)(promise.wait(), promise);
+  }
+}
 
 } // namespace _sync_wait
 
@@ -177,67 +264,69 @@ namespace _sync_wait_cpo {
     template <
         typename Sender,
         typename StopToken = unstoppable_token,
-        typename Result = single_value_result_t<std::remove_cvref_t<Sender>>>
+        typename Result = single_value_result_t<std::remove_cvref_t<Sender>>,
+        typename ErrorVariant =
+            detail::error_variant_t<std::remove_cvref_t<Sender>>>
     auto operator()(Sender&& sender, StopToken&& stopToken = {}) const
         -> std::optional<Result> {
-      auto blockingResult = blocking(sender);
-      if (blockingResult == blocking_kind::always ||
-          blockingResult == blocking_kind::always_inline) {
-        using promise_t = _sync_wait::thread_unsafe_promise<Result>;
-        promise_t promise;
-
-        auto operation = connect(
+      return _sync_wait::wait<Result, ErrorVariant>(
           std::move(sender),
-          _sync_wait::thread_unsafe_receiver<Result, StopToken&&>{
-            promise, std::move(stopToken)});
-
-        start(operation);
-
-        assert(promise.state_ != promise_t::state::incomplete);
-
-        switch (promise.state_) {
-          case promise_t::state::done:
-            return std::nullopt;
-          case promise_t::state::value:
-            return std::move(promise.value_).get();
-          case promise_t::state::error:
-            std::rethrow_exception(promise.exception_.get());
-          default:
-            std::terminate();
-        }
-      } else {
-        using promise_t = _sync_wait::promise<Result>;
-        promise_t promise;
-
-        // Store state for the operation on the stack.
-        auto operation = connect(
-            std::move(sender),
-            _sync_wait::receiver<Result, StopToken&&>{
-              promise, std::move(stopToken)});
-
-        start(operation);
-
-        std::unique_lock lock{promise.mutex_};
-        promise.cv_.wait(
-            lock, [&] { return promise.state_ != promise_t::state::incomplete; });
-
-        switch (promise.state_) {
-          case promise_t::state::done:
-            return std::nullopt;
-          case promise_t::state::value:
-            return std::move(promise.value_).get();
-          case promise_t::state::error:
-            std::rethrow_exception(promise.exception_.get());
-          default:
-            std::terminate();
-        }
-      }
+          std::move(stopToken),
+          [](_sync_wait::state s, auto& promise) -> std::optional<Result> {
+            switch (s) {
+              case _sync_wait::state::done:
+                return std::nullopt;
+              case _sync_wait::state::value:
+                return std::move(promise.value_).get();
+              case _sync_wait::state::error:
+                detail::throw_error(std::move(promise.error_).get());
+              default:
+                std::terminate();
+            }
+          });
     }
   };
 } // namespace _sync_wait_cpo
 
 inline constexpr _sync_wait_cpo::_fn sync_wait {};
 
+namespace _sync_wait_or_error_cpo {
+  struct _fn {
+    // As sync_wait(), but returns an error instead of throwing it. The first
+    // alternative holds the value, or std::nullopt if the sender completed
+    // with set_done().
+    template <
+        typename Sender,
+        typename StopToken = unstoppable_token,
+        typename Result = single_value_result_t<std::remove_cvref_t<Sender>>,
+        typename ErrorVariant =
+            detail::error_variant_t<std::remove_cvref_t<Sender>>>
+    auto operator()(Sender&& sender, StopToken&& stopToken = {}) const
+        -> detail::or_error_t<Result, ErrorVariant> {
+      using result_t = detail::or_error_t<Result, ErrorVariant>;
+      return _sync_wait::wait<Result, ErrorVariant>(
+          std::move(sender),
+          std::move(stopToken),
+          [](_sync_wait::state s, auto& promise) -> result_t {
+            switch (s) {
+              case _sync_wait::state::done:
+                return result_t{std::in_place_index<0>};
+              case _sync_wait::state::value:
+                return result_t{
+                    std::in_place_index<0>, std::move(promise.value_).get()};
+              case _sync_wait::state::error:
+                return detail::to_or_error<result_t>(
+                    std::move(promise.error_).get());
+              default:
+                std::terminate();
+            }
+          });
+    }
+  };
+} // namespace _sync_wait_or_error_cpo
+
+inline constexpr _sync_wait_or_error_cpo::_fn sync_wait_or_error {};
+
 namespace _sync_wait_r_cpo {
   template <typename Result>
   struct _fn {
@@ -253,4 +342,24 @@ namespace _sync_wait_r_cpo {
 template <typename Result>
 inline constexpr _sync_wait_r_cpo::_fn<Result> sync_wait_r {};
 
+namespace _sync_wait_on_cpo {
+  struct _fn {
+    // Runs 'loop' on the calling thread until 'sender' completes, so that
+    // work the sender schedules onto 'loop' runs inline.
+    template <
+        typename EventLoop,
+        typename Sender,
+        typename StopToken = unstoppable_token>
+    auto operator()(
+        EventLoop& loop,
+        Sender&& sender,
+        StopToken&& stopToken = {}) const
+        -> decltype(loop.sync_wait((Sender &&) sender, (StopToken &&) stopToken)) {
+      return loop.sync_wait((Sender &&) sender, (StopToken &&) stopToken);
+    }
+  };
+} // namespace _sync_wait_on_cpo
+
+inline constexpr _sync_wait_on_cpo::_fn sync_wait_on {};
+
 } // namespace unifex
@@ -18,143 +18,366 @@
 #include <unifex/async_trace.hpp>
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/coroutine.hpp>
+#include <unifex/pool_allocator.hpp>
 
 #if UNIFEX_NO_COROUTINES
 # error "C++20 coroutine support is required to use this header"
 #endif
 
+#include <cstddef>
 #include <exception>
+#include <memory>
+#include <new>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace unifex {
-
 template <typename T>
-struct task {
-  struct promise_type {
-    task get_return_object() noexcept {
-      return task{
-          coro::coroutine_handle<promise_type>::from_promise(*this)};
-    }
+struct task;
 
-    coro::suspend_always initial_suspend() noexcept {
-      return {};
-    }
+namespace _task {
 
-    auto final_suspend() noexcept {
-      struct awaiter {
-        bool await_ready() {
-          return false;
-        }
-        auto await_suspend(
-            coro::coroutine_handle<promise_type> h) noexcept {
-          return h.promise().continuation_;
-        }
-        void await_resume() noexcept {}
-      };
-      return awaiter{};
-    }
+// Allocation of coroutine frames.
+//
+// Frames are allocated from the process-wide pool behind pool_allocator<T>,
+// whose per-thread caches recycle fixed-size blocks, so that a chain of
+// short-lived tasks doesn't go to the global heap for every call.
+//
+// A task<T> coroutine that takes 'std::allocator_arg_t, const Allocator&'
+// as its first two parameters has its frame allocated from that allocator
+// instead, by a promise type chosen through coroutine_traits (see
+// allocator_promise below). (The allocator of a receiver that later awaits
+// the task is not known when the frame is allocated.)
+//
+// Either way the frame is followed by a pointer to the function that frees
+// it, and by the allocator if there is one.
+struct frame_allocation {
+  using deallocate_fn = void(void* frame, std::size_t size) noexcept;
 
-    void unhandled_exception() noexcept {
-      reset_value();
-      exception_.construct(std::current_exception());
-      state_ = state::exception;
-    }
+  // The unit of allocation from a user-provided allocator.
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block {
+    unsigned char data[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+  };
 
-    template <
-        typename Value,
-        std::enable_if_t<std::is_convertible_v<Value, T>, int> = 0>
-    void return_value(Value&& value) noexcept(
-        std::is_nothrow_constructible_v<T, Value>) {
-      reset_value();
-      value_.construct(std::move(value));
-      state_ = state::value;
-    }
+  template <typename Allocator>
+  using block_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+  template <typename Allocator>
+  using block_traits = std::allocator_traits<block_allocator<Allocator>>;
+
+  static constexpr std::size_t align_up(
+      std::size_t size, std::size_t alignment) noexcept {
+    return (size + alignment - 1) & ~(alignment - 1);
+  }
+
+  static constexpr std::size_t deallocate_offset(std::size_t size) noexcept {
+    return align_up(size, alignof(deallocate_fn*));
+  }
+
+  static constexpr std::size_t pooled_size(std::size_t size) noexcept {
+    return deallocate_offset(size) + sizeof(deallocate_fn*);
+  }
+
+  template <typename Allocator>
+  static constexpr std::size_t allocator_offset(std::size_t size) noexcept {
+    return align_up(pooled_size(size), alignof(block_allocator<Allocator>));
+  }
+
+  template <typename Allocator>
+  static constexpr std::size_t block_count(std::size_t size) noexcept {
+    return (allocator_offset<Allocator>(size) +
+            sizeof(block_allocator<Allocator>) + sizeof(block) - 1) /
+        sizeof(block);
+  }
 
-    promise_type() noexcept {}
+  static void* operator new(std::size_t size) {
+    void* frame =
+        _pool::allocate(pooled_size(size), __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    ::new (static_cast<char*>(frame) + deallocate_offset(size))
+        deallocate_fn*(&deallocate_pooled);
+    return frame;
+  }
+
+  // Allocates a frame of 'size' bytes from 'allocator'.
+  template <typename Allocator>
+  static void* allocate_with(std::size_t size, const Allocator& allocator) {
+    static_assert(
+        alignof(block_allocator<Allocator>) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+        "Over-aligned allocators are not supported");
+    block_allocator<Allocator> blockAllocator{allocator};
+    void* frame = block_traits<Allocator>::allocate(
+        blockAllocator, block_count<Allocator>(size));
+    ::new (static_cast<char*>(frame) + deallocate_offset(size))
+        deallocate_fn*(&deallocate_with<Allocator>);
+    ::new (static_cast<char*>(frame) + allocator_offset<Allocator>(size))
+        block_allocator<Allocator>(std::move(blockAllocator));
+    return frame;
+  }
 
-    ~promise_type() {
-      reset_value();
+  static void operator delete(void* frame, std::size_t size) noexcept {
+    deallocate_fn* deallocate = *std::launder(reinterpret_cast<deallocate_fn**>(
+        static_cast<char*>(frame) + deallocate_offset(size)));
+    deallocate(frame, size);
+  }
+
+  static void deallocate_pooled(void* frame, std::size_t size) noexcept {
+    _pool::deallocate(
+        frame, pooled_size(size), __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  }
+
+  template <typename Allocator>
+  static void deallocate_with(void* frame, std::size_t size) noexcept {
+    auto* stored = std::launder(reinterpret_cast<block_allocator<Allocator>*>(
+        static_cast<char*>(frame) + allocator_offset<Allocator>(size)));
+    block_allocator<Allocator> blockAllocator{std::move(*stored)};
+    stored->~block_allocator<Allocator>();
+    block_traits<Allocator>::deallocate(
+        blockAllocator, static_cast<block*>(frame), block_count<Allocator>(size));
+  }
+};
+
+struct final_awaiter {
+  bool await_ready() noexcept {
+    return false;
+  }
+  // Resumes the awaiting coroutine by symmetric transfer.
+  template <typename Promise>
+  coro::coroutine_handle<> await_suspend(
+      coro::coroutine_handle<Promise> h) noexcept {
+    return h.promise().continuation_;
+  }
+  void await_resume() noexcept {}
+};
+
+struct promise_base : frame_allocation {
+  coro::suspend_always initial_suspend() noexcept {
+    return {};
+  }
+
+  final_awaiter final_suspend() noexcept {
+    return {};
+  }
+
+  template <typename Func>
+  friend void
+  tag_invoke(tag_t<visit_continuations>, const promise_base& p, Func&& func) {
+    if (p.info_) {
+      visit_continuations(*p.info_, std::move(func));
     }
+  }
+
+  coro::coroutine_handle<> continuation_;
+  std::optional<continuation_info> info_;
+};
 
-    void reset_value() noexcept {
-      switch (std::exchange(state_, state::empty)) {
-        case state::value:
-          value_.destruct();
-          break;
-        case state::exception:
-          exception_.destruct();
-          break;
-        default:
-          break;
-      }
+// The result of a task<T>: either a T or an exception.
+template <typename T>
+struct result_storage {
+  result_storage() noexcept {}
+
+  ~result_storage() {
+    reset_value();
+  }
+
+  void unhandled_exception() noexcept {
+    reset_value();
+    exception_.construct(std::current_exception());
+    state_ = state::exception;
+  }
+
+  template <
+      typename Value,
+      std::enable_if_t<std::is_convertible_v<Value, T>, int> = 0>
+  void return_value(Value&& value) noexcept(
+      std::is_nothrow_constructible_v<T, Value>) {
+    reset_value();
+    value_.construct(std::move(value));
+    state_ = state::value;
+  }
+
+  void reset_value() noexcept {
+    switch (std::exchange(state_, state::empty)) {
+      case state::value:
+        value_.destruct();
+        break;
+      case state::exception:
+        exception_.destruct();
+        break;
+      default:
+        break;
     }
+  }
 
-    decltype(auto) result() {
-      if (state_ == state::exception) {
-        std::rethrow_exception(std::move(exception_).get());
-      }
-      return std::move(value_).get();
+  decltype(auto) result() {
+    if (state_ == state::exception) {
+      std::rethrow_exception(std::move(exception_).get());
     }
+    return std::move(value_).get();
+  }
+
+  enum class state { empty, value, exception };
 
-    template <typename Func>
-    friend void
-    tag_invoke(tag_t<visit_continuations>, const promise_type& p, Func&& func) {
-      if (p.info_) {
-        visit_continuations(*p.info_, std::move(func));
-      }
+  state state_ = state::empty;
+  union {
+    manual_lifetime<T> value_;
+    manual_lifetime<std::exception_ptr> exception_;
+  };
+};
+
+template <>
+struct result_storage<void> {
+  void unhandled_exception() noexcept {
+    exception_ = std::current_exception();
+  }
+
+  void return_void() noexcept {}
+
+  void result() {
+    if (exception_) {
+      std::rethrow_exception(std::move(exception_));
     }
+  }
+
+  std::exception_ptr exception_;
+};
+
+// Returns the allocator passed after 'std::allocator_arg' to a coroutine,
+// which member functions and lambdas are passed after the object.
+template <typename Allocator, typename... Args>
+const Allocator& frame_allocator(
+    std::allocator_arg_t, const Allocator& allocator, const Args&...) noexcept {
+  return allocator;
+}
 
-    enum class state { empty, value, exception };
+template <typename Allocator, typename Class, typename... Args>
+const Allocator& frame_allocator(
+    const Class&,
+    std::allocator_arg_t,
+    const Allocator& allocator,
+    const Args&...) noexcept {
+  return allocator;
+}
 
-    coro::coroutine_handle<> continuation_;
-    state state_ = state::empty;
-    union {
-      manual_lifetime<T> value_;
-      manual_lifetime<std::exception_ptr> exception_;
-    };
-    std::optional<continuation_info> info_;
+template <typename T, typename Allocator, typename... Params>
+struct _allocator_promise {
+  struct type;
+};
+template <typename T, typename Allocator, typename... Params>
+using allocator_promise =
+    typename _allocator_promise<T, std::remove_cvref_t<Allocator>, Params...>::
+        type;
+
+// The promise of a task<T> coroutine with parameters 'Params...' whose
+// frame is allocated from the allocator among them.
+//
+// operator new is a non-template member of the same class as the matching
+// operator delete, rather than a template in frame_allocation, so that the
+// compiler sees the pair as matching.
+template <typename T, typename Allocator, typename... Params>
+struct _allocator_promise<T, Allocator, Params...>::type
+  : task<T>::promise_type {
+  static void* operator new(std::size_t size, const Params&... params) {
+    return frame_allocation::allocate_with(
+        size, frame_allocator<Allocator>(params...));
+  }
+
+  static void operator delete(void* frame, std::size_t size) noexcept {
+    frame_allocation::operator delete(frame, size);
+  }
+
+  task<T> get_return_object() noexcept {
+    return task<T>{coro::coroutine_handle<type>::from_promise(*this)};
+  }
+};
+
+} // namespace _task
+
+template <typename T>
+struct task {
+  struct promise_type : _task::promise_base, _task::result_storage<T> {
+    task get_return_object() noexcept {
+      return task{
+          coro::coroutine_handle<promise_type>::from_promise(*this)};
+    }
   };
 
-  coro::coroutine_handle<promise_type> coro_;
+  // The promise may be derived from promise_type (see allocator_promise).
+  coro::coroutine_handle<> coro_;
+  promise_type* promise_;
 
-  explicit task(coro::coroutine_handle<promise_type> h) noexcept
-      : coro_(h) {}
+  template <typename Promise>
+  explicit task(coro::coroutine_handle<Promise> h) noexcept
+      : coro_(h), promise_(&h.promise()) {}
 
   ~task() {
     if (coro_)
       coro_.destroy();
   }
 
-  task(task&& t) noexcept : coro_(std::exchange(t.coro_, {})) {}
+  task(task&& t) noexcept
+      : coro_(std::exchange(t.coro_, {})),
+        promise_(std::exchange(t.promise_, nullptr)) {}
 
   task& operator=(task t) noexcept {
     std::swap(coro_, t.coro_);
+    std::swap(promise_, t.promise_);
     return *this;
   }
 
 private:
   struct awaiter {
-    coro::coroutine_handle<promise_type> coro_;
+    coro::coroutine_handle<> coro_;
+    promise_type* promise_;
     bool await_ready() noexcept {
       return false;
     }
     template <typename OtherPromise>
     auto await_suspend(
         coro::coroutine_handle<OtherPromise> h) noexcept {
-      coro_.promise().continuation_ = h;
-      coro_.promise().info_.emplace(
+      promise_->continuation_ = h;
+      promise_->info_.emplace(
           continuation_info::from_continuation(h.promise()));
       return coro_;
     }
     decltype(auto) await_resume() {
-      return coro_.promise().result();
+      return promise_->result();
     }
   };
 
 public:
   auto operator co_await() && noexcept {
-    return awaiter{coro_};
+    return awaiter{coro_, promise_};
   }
 };
 
 } // namespace unifex
+
+// Coroutines returning a task<T> that take 'std::allocator_arg_t,
+// const Allocator&' first, or after the object for member functions and
+// lambdas, allocate their frame from that allocator.
+template <typename T, typename Allocator, typename... Args>
+struct unifex::coro::coroutine_traits<
+    unifex::task<T>,
+    std::allocator_arg_t,
+    Allocator,
+    Args...> {
+  using promise_type = unifex::_task::
+      allocator_promise<T, Allocator, std::allocator_arg_t, Allocator, Args...>;
+};
+
+template <typename T, typename Class, typename Allocator, typename... Args>
+struct unifex::coro::coroutine_traits<
+    unifex::task<T>,
+    Class,
+    std::allocator_arg_t,
+    Allocator,
+    Args...> {
+  using promise_type = unifex::_task::allocator_promise<
+      T,
+      Allocator,
+      Class,
+      std::allocator_arg_t,
+      Allocator,
+      Args...>;
+};
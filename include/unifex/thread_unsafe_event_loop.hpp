@@ -19,6 +19,7 @@
 #include <unifex/get_stop_token.hpp>
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
 
@@ -302,6 +303,12 @@ namespace _thread_unsafe_event_loop {
         return r.get_stop_token();
       }
 
+      friend scheduler tag_invoke(
+          tag_t<get_scheduler>,
+          const receiver& r) noexcept {
+        return r.get_scheduler();
+      }
+
      private:
       friend sync_wait_promise;
 
@@ -309,6 +316,10 @@ namespace _thread_unsafe_event_loop {
         return promise_.stopToken_;
       }
 
+      scheduler get_scheduler() const noexcept {
+        return promise_.scheduler_;
+      }
+
       explicit receiver(sync_wait_promise& promise) noexcept
         : promise_(promise) {}
 
@@ -316,8 +327,8 @@ namespace _thread_unsafe_event_loop {
     };
 
    public:
-    explicit type(StopToken&& stopToken) noexcept
-      : stopToken_(std::move(stopToken)) {}
+    explicit type(scheduler s, StopToken&& stopToken) noexcept
+      : scheduler_(s), stopToken_(std::move(stopToken)) {}
 
     ~type() {
       if (state_ == state::value) {
@@ -352,6 +363,7 @@ namespace _thread_unsafe_event_loop {
     };
 
     state state_ = state::incomplete;
+    scheduler scheduler_;
     StopToken stopToken_;
   };
 } // namespace _thread_unsafe_event_loop
@@ -382,7 +394,7 @@ class thread_unsafe_event_loop {
       typename Result = single_value_result_t<std::remove_cvref_t<Sender>>>
   std::optional<Result> sync_wait(Sender&& sender, StopToken st = {}) {
     using promise_t = _thread_unsafe_event_loop::sync_wait_promise<Result, StopToken&&>;
-    promise_t promise{(StopToken &&) st};
+    promise_t promise{get_scheduler(), (StopToken &&) st};
 
     auto op = connect(std::move(sender), promise.get_receiver());
     start(op);
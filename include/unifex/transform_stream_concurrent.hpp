@@ -0,0 +1,435 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/detail/buffered_stream.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace unifex {
+namespace _tfx_concurrent {
+
+using _buffered::waiter_base;
+
+template <typename Stream, typename Scheduler, typename Func>
+struct _state {
+  class type;
+};
+template <typename Stream, typename Scheduler, typename Func>
+using state = typename _state<Stream, Scheduler, Func>::type;
+
+template <typename Stream, typename Scheduler, typename Func>
+struct _work_receiver {
+  class type;
+};
+template <typename Stream, typename Scheduler, typename Func>
+using work_receiver = typename _work_receiver<Stream, Scheduler, Func>::type;
+
+template <typename Stream, typename Scheduler, typename Func>
+class _work_receiver<Stream, Scheduler, Func>::type {
+ public:
+  explicit type(state<Stream, Scheduler, Func>& s, std::size_t slot) noexcept
+    : state_(s), slot_(slot) {}
+
+  void set_value() && noexcept {
+    state_.run_work(slot_);
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    if constexpr (std::is_same_v<
+                      std::remove_cvref_t<Error>,
+                      std::exception_ptr>) {
+      state_.abandon_work(slot_, (Error &&) error);
+    } else {
+      state_.abandon_work(slot_, std::make_exception_ptr((Error &&) error));
+    }
+  }
+
+  void set_done() && noexcept {
+    state_.abandon_work(slot_, nullptr);
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_token();
+  }
+
+ private:
+  state<Stream, Scheduler, Func>& state_;
+  std::size_t slot_;
+};
+
+// The state shared by the concurrent transform stream and its operations.
+//
+// Each value read from the source stream is placed in one of 'maxInFlight'
+// slots and 'func' is applied to it on 'scheduler'. The source stream is
+// only read while a slot is free, so at most 'maxInFlight' values are being
+// transformed or waiting to be consumed at any time.
+//
+// 'order_' is a ring of slot indices in the order that results are to be
+// delivered: slots are appended as they are dispatched when preserving the
+// order of the source stream, or as they complete otherwise.
+//
+// 'func_' is shared by all slots and may be invoked concurrently from
+// several of the scheduler's threads, so it must be safe to call
+// concurrently.
+template <typename Stream, typename Scheduler, typename Func>
+class _state<Stream, Scheduler, Func>::type
+  : public _buffered::state_base<type, Stream> {
+  using base = _buffered::state_base<type, Stream>;
+  friend base;
+  template <typename State>
+  friend struct _buffered::_fetch_receiver;
+  template <typename Stream2, typename Scheduler2, typename Func2>
+  friend struct _work_receiver;
+
+  using base::consumer_;
+  using base::fetching_;
+  using base::mutex_;
+  using base::stopping_;
+
+  using input_type = typename next_sender_t<Stream>::template value_types<
+      single_type_t,
+      decayed_tuple<std::tuple>::template apply>;
+  using invoke_result_type = decltype(std::apply(
+      std::declval<Func&>(), std::declval<input_type&&>()));
+
+ public:
+  using value_type = non_void_t<std::remove_cvref_t<invoke_result_type>>;
+
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = std::conditional_t<
+      std::is_same_v<value_type, unit>,
+      Variant<Tuple<>>,
+      Variant<Tuple<value_type>>>;
+
+  template <typename Stream2, typename Scheduler2, typename Func2>
+  explicit type(
+      Stream2&& stream,
+      Scheduler2&& scheduler,
+      std::size_t maxInFlight,
+      Func2&& func,
+      bool ordered)
+    : base((Stream2 &&) stream),
+      scheduler_((Scheduler2 &&) scheduler),
+      func_((Func2 &&) func),
+      slots_(new slot[maxInFlight]),
+      order_(new std::size_t[maxInFlight]),
+      capacity_(maxInFlight),
+      ordered_(ordered) {
+    assert(maxInFlight > 0);
+    freeSlots_.reserve(maxInFlight);
+    for (std::size_t i = maxInFlight; i > 0; --i) {
+      freeSlots_.push_back(i - 1);
+    }
+  }
+
+  ~type() {
+    assert(running_ == 0);
+  }
+
+  // Tries to take the next result for the consumer.
+  //
+  // If none is available yet then 'waiter' is parked until one is and
+  // 'false' is returned. Otherwise, exactly one of 'value', 'error' or
+  // neither (for end-of-stream) is filled in and 'true' is returned.
+  bool try_take(
+      waiter_base* waiter,
+      std::optional<value_type>& value,
+      std::exception_ptr& error) noexcept {
+    std::unique_lock lock{mutex_};
+    bool result = true;
+    if (result_ready()) {
+      std::size_t index = order_[orderHead_];
+      orderHead_ = (orderHead_ + 1) % capacity_;
+      --orderSize_;
+
+      slot& s = slots_[index];
+      if (s.error_) {
+        error = std::exchange(s.error_, nullptr);
+      } else {
+        value = std::move(s.result_);
+      }
+      s.result_.reset();
+      s.complete_ = false;
+      freeSlots_.push_back(index);
+    } else if (freeSlots_.size() == capacity_ && sourceDone_) {
+      error = std::exchange(error_, nullptr);
+    } else {
+      consumer_ = waiter;
+      result = false;
+    }
+    bool shouldFetch = start_fetching();
+    lock.unlock();
+
+    if (shouldFetch) {
+      this->fetch();
+    }
+    return result;
+  }
+
+  template <typename Receiver>
+  static void deliver_value(Receiver&& receiver, value_type&& value) noexcept {
+    if constexpr (std::is_same_v<value_type, unit>) {
+      unifex::set_value((Receiver &&) receiver);
+    } else {
+      unifex::set_value((Receiver &&) receiver, std::move(value));
+    }
+  }
+
+ private:
+  using work_op_t = operation_t<
+      callable_result_t<tag_t<schedule>, Scheduler&>,
+      work_receiver<Stream, Scheduler, Func>>;
+
+  struct slot {
+    std::optional<input_type> input_;
+    std::optional<value_type> result_;
+    std::exception_ptr error_;
+    // True once the transformation has finished, with either a result, an
+    // error or, if neither is set, done.
+    bool complete_ = false;
+    manual_lifetime<work_op_t> op_;
+  };
+
+  // Must be called with the mutex held.
+  bool result_ready() const noexcept {
+    return orderSize_ > 0 && slots_[order_[orderHead_]].complete_;
+  }
+
+  // Must be called with the mutex held.
+  bool start_fetching() noexcept {
+    if (fetching_ || stopping_ || sourceDone_ || freeSlots_.empty()) {
+      return false;
+    }
+    fetching_ = true;
+    return true;
+  }
+
+  // Must be called with the mutex held.
+  void push_order(std::size_t index) noexcept {
+    order_[(orderHead_ + orderSize_) % capacity_] = index;
+    ++orderSize_;
+  }
+
+  // Must be called with the mutex held. Results of transformations that
+  // are still running are discarded as they complete.
+  void discard() noexcept {}
+
+  // Must be called with the mutex held.
+  bool in_flight() const noexcept {
+    return fetching_ || running_ > 0;
+  }
+
+  template <typename... Values>
+  void fetch_value(Values&&... values) noexcept {
+    std::unique_lock lock{mutex_};
+    if (stopping_) {
+      lock.unlock();
+      this->destroy_fetch();
+      lock.lock();
+      fetching_ = false;
+      this->stopped(std::move(lock));
+      return;
+    }
+
+    std::size_t index = freeSlots_.back();
+    freeSlots_.pop_back();
+    slot& s = slots_[index];
+    try {
+      s.input_.emplace((Values &&) values...);
+    } catch (...) {
+      s.error_ = std::current_exception();
+      s.complete_ = true;
+    }
+    this->destroy_fetch();
+    fetching_ = false;
+    if (ordered_ || s.complete_) {
+      push_order(index);
+    }
+    const bool shouldDispatch = !s.complete_;
+    if (shouldDispatch) {
+      ++running_;
+    }
+    waiter_base* consumer =
+        result_ready() ? std::exchange(consumer_, nullptr) : nullptr;
+    bool shouldFetch = start_fetching();
+    lock.unlock();
+
+    if (shouldDispatch) {
+      dispatch(index);
+    }
+    if (shouldFetch) {
+      this->fetch();
+    }
+    this->resume(consumer);
+  }
+
+  void end_fetch(std::exception_ptr error) noexcept {
+    std::unique_lock lock{mutex_};
+    fetching_ = false;
+    if (stopping_) {
+      this->stopped(std::move(lock));
+      return;
+    }
+    sourceDone_ = true;
+    error_ = std::move(error);
+    waiter_base* consumer = nullptr;
+    if (result_ready() || freeSlots_.size() == capacity_) {
+      consumer = std::exchange(consumer_, nullptr);
+    }
+    lock.unlock();
+
+    this->resume(consumer);
+  }
+
+  void dispatch(std::size_t index) noexcept {
+    slot& s = slots_[index];
+    try {
+      s.op_.construct_from([&] {
+        return unifex::connect(
+            schedule(scheduler_),
+            work_receiver<Stream, Scheduler, Func>{*this, index});
+      });
+    } catch (...) {
+      complete_work(index, std::current_exception());
+      return;
+    }
+    unifex::start(s.op_.get());
+  }
+
+  // Called on the scheduler's execution context.
+  void run_work(std::size_t index) noexcept {
+    slot& s = slots_[index];
+    s.op_.destruct();
+    std::exception_ptr error;
+    try {
+      if (this->get_token().stop_requested()) {
+        // The stream is being cleaned up and the result would be discarded.
+      } else if constexpr (std::is_void_v<invoke_result_type>) {
+        std::apply(func_, std::move(*s.input_));
+        s.result_.emplace();
+      } else {
+        s.result_.emplace(std::apply(func_, std::move(*s.input_)));
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    s.input_.reset();
+    complete_work(index, std::move(error));
+  }
+
+  void abandon_work(std::size_t index, std::exception_ptr error) noexcept {
+    slot& s = slots_[index];
+    s.op_.destruct();
+    s.input_.reset();
+    complete_work(index, std::move(error));
+  }
+
+  void complete_work(std::size_t index, std::exception_ptr error) noexcept {
+    std::unique_lock lock{mutex_};
+    slot& s = slots_[index];
+    s.error_ = std::move(error);
+    s.complete_ = true;
+    --running_;
+    if (stopping_) {
+      s.result_.reset();
+      s.error_ = nullptr;
+      this->stopped(std::move(lock));
+      return;
+    }
+    if (!ordered_) {
+      push_order(index);
+    }
+    waiter_base* consumer =
+        result_ready() ? std::exchange(consumer_, nullptr) : nullptr;
+    lock.unlock();
+
+    this->resume(consumer);
+  }
+
+  Scheduler scheduler_;
+  Func func_;
+  const std::unique_ptr<slot[]> slots_;
+  const std::unique_ptr<std::size_t[]> order_;
+  const std::size_t capacity_;
+  const bool ordered_;
+  std::size_t orderHead_ = 0;
+  std::size_t orderSize_ = 0;
+  std::vector<std::size_t> freeSlots_;
+  std::size_t running_ = 0;
+  bool sourceDone_ = false;
+  std::exception_ptr error_;
+};
+
+template <typename Stream, typename Scheduler, typename Func>
+using stream = _buffered::stream<state<
+    std::remove_cvref_t<Stream>,
+    std::remove_cvref_t<Scheduler>,
+    std::remove_cvref_t<Func>>>;
+
+template <bool Ordered>
+struct _fn {
+  template <typename Stream, typename Scheduler, typename Func>
+  stream<Stream, Scheduler, Func> operator()(
+      Stream&& source,
+      Scheduler&& scheduler,
+      std::size_t maxInFlight,
+      Func&& func) const {
+    using state_t = state<
+        std::remove_cvref_t<Stream>,
+        std::remove_cvref_t<Scheduler>,
+        std::remove_cvref_t<Func>>;
+    return stream<Stream, Scheduler, Func>{std::make_unique<state_t>(
+        (Stream &&) source,
+        (Scheduler &&) scheduler,
+        maxInFlight,
+        (Func &&) func,
+        Ordered)};
+  }
+};
+
+} // namespace _tfx_concurrent
+
+inline constexpr _tfx_concurrent::_fn<true> transform_stream_concurrent{};
+inline constexpr _tfx_concurrent::_fn<false>
+    transform_stream_concurrent_unordered{};
+
+} // namespace unifex
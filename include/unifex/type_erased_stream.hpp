@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <unifex/any_unique.hpp>
 #include <unifex/async_trace.hpp>
 #include <unifex/config.hpp>
 #include <unifex/receiver_concepts.hpp>
@@ -24,20 +25,23 @@
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/get_stop_token.hpp>
 
-#include <unifex/get_stop_token.hpp>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <utility>
 
 namespace unifex {
 namespace _type_erase {
 
-template <typename... Values>
+template <std::size_t InlineSize, typename... Values>
 struct _stream {
   struct type;
 };
-template <typename... Values>
-using stream = typename _stream<Values...>::type;
+template <std::size_t InlineSize, typename... Values>
+using stream = typename _stream<InlineSize, Values...>::type;
 
-template <typename... Values>
-struct _stream<Values...>::type {
+template <std::size_t InlineSize, typename... Values>
+struct _stream<InlineSize, Values...>::type {
   struct next_receiver_base {
     virtual void set_value(Values&&... values) noexcept = 0;
     virtual void set_done() noexcept = 0;
@@ -75,6 +79,11 @@ struct _stream<Values...>::type {
 
   struct stream_base {
     virtual ~stream_base() {}
+
+    // Move this stream into 'buffer' and destroy *this.
+    // Only called for streams that are stored inline.
+    virtual stream_base* relocate(void* buffer) noexcept = 0;
+
     virtual void start_next(
         next_receiver_base& receiver,
         inplace_stop_token stopToken) noexcept = 0;
@@ -229,6 +238,17 @@ struct _stream<Values...>::type {
 
       ~type() {}
 
+      stream_base* relocate(void* buffer) noexcept override {
+        if constexpr (std::is_nothrow_move_constructible_v<Stream>) {
+          stream_base* moved = ::new (buffer) type(std::move(stream_));
+          this->~type();
+          return moved;
+        } else {
+          // Such streams are never stored inline.
+          std::terminate();
+        }
+      }
+
       union {
         manual_lifetime<next_operation_t<Stream, next_receiver_wrapper>>
             next_;
@@ -359,14 +379,75 @@ struct _stream<Values...>::type {
     }
   };
 
-  std::unique_ptr<stream_base> stream_;
+  using storage_t = _any_unique::_storage<InlineSize>;
+
+  template <typename ConcreteStream>
+  static constexpr bool fits_inline =
+      storage_t::has_inline_storage &&
+      sizeof(stream<ConcreteStream>) <= InlineSize &&
+      alignof(stream<ConcreteStream>) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<ConcreteStream>;
 
   template <typename ConcreteStream>
-  explicit type(ConcreteStream&& strm)
-    : stream_(
-        std::make_unique<type::stream<ConcreteStream>>(
-            std::move(strm))) {}
+  explicit type(ConcreteStream&& strm) {
+    using concrete_stream = type::stream<ConcreteStream>;
+    if constexpr (fits_inline<std::remove_cvref_t<ConcreteStream>>) {
+      stream_ = ::new (storage_.buffer()) concrete_stream(std::move(strm));
+    } else {
+      stream_ = new concrete_stream(std::move(strm));
+    }
+  }
+
+  type(type&& other) noexcept {
+    take(other);
+  }
+
+  type& operator=(type&& other) noexcept {
+    if (this != &other) {
+      reset();
+      take(other);
+    }
+    return *this;
+  }
+
+  ~type() {
+    reset();
+  }
+
+ private:
+  bool is_inline() const noexcept {
+    if constexpr (storage_t::has_inline_storage) {
+      auto* p = reinterpret_cast<const unsigned char*>(stream_);
+      return p >= storage_.buffer_ && p < storage_.buffer_ + InlineSize;
+    } else {
+      return false;
+    }
+  }
+
+  void take(type& other) noexcept {
+    if constexpr (storage_t::has_inline_storage) {
+      if (other.is_inline()) {
+        stream_ = other.stream_->relocate(storage_.buffer());
+        other.stream_ = nullptr;
+        return;
+      }
+    }
+    stream_ = std::exchange(other.stream_, nullptr);
+  }
 
+  void reset() noexcept {
+    if (is_inline()) {
+      stream_->~stream_base();
+    } else {
+      delete stream_;
+    }
+    stream_ = nullptr;
+  }
+
+  stream_base* stream_ = nullptr;
+  UNIFEX_NO_UNIQUE_ADDRESS storage_t storage_;
+
+ public:
   friend next_sender tag_invoke(tag_t<next>, type& s) noexcept {
     return next_sender{*s.stream_};
   }
@@ -378,16 +459,28 @@ struct _stream<Values...>::type {
 } // namespace _type_erase
 
 namespace _type_erase_cpo {
-  template <typename... Ts>
+  template <std::size_t InlineSize, typename... Ts>
   struct _fn {
     template <typename Stream>
-    _type_erase::stream<Ts...> operator()(Stream&& strm) const {
-      return _type_erase::stream<Ts...>{std::move(strm)};
+    _type_erase::stream<InlineSize, Ts...> operator()(Stream&& strm) const {
+      return _type_erase::stream<InlineSize, Ts...>{std::move(strm)};
     }
   };
 } // namespace _type_erase_cpo
 
 template <typename... Ts>
-inline constexpr _type_erase_cpo::_fn<Ts...> type_erase {};
+using type_erased_stream = _type_erase::stream<0, Ts...>;
+
+template <typename... Ts>
+inline constexpr _type_erase_cpo::_fn<0, Ts...> type_erase {};
+
+// As type_erase<Ts...>() but streams whose type-erased state fits within
+// InlineSize bytes, and that are nothrow move-constructible, are stored
+// inline rather than being heap-allocated.
+template <std::size_t InlineSize, typename... Ts>
+using small_type_erased_stream = _type_erase::stream<InlineSize, Ts...>;
+
+template <std::size_t InlineSize, typename... Ts>
+inline constexpr _type_erase_cpo::_fn<InlineSize, Ts...> small_type_erase {};
 
 } // namespace unifex
@@ -21,6 +21,7 @@
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
 #include <unifex/type_traits.hpp>
 #include <unifex/type_list.hpp>
 #include <unifex/blocking.hpp>
@@ -88,6 +89,52 @@ struct cancel_operation {
   }
 };
 
+// Storage for the result of a child sender.
+//
+// The result is delivered as a variant of tuples, one per overload of
+// set_value() the child may call. Children that only have one overload
+// store the tuple directly and only wrap it in a variant on delivery.
+template <typename Sender, typename = void>
+struct _value_storage {
+  using variant_t =
+      typename Sender::template value_types<std::variant, std::tuple>;
+
+  template <typename... Values>
+  void emplace(Values&&... values) {
+    value_.emplace(
+        std::in_place_type<std::tuple<Values...>>, std::move(values)...);
+  }
+
+  variant_t get() && {
+    return std::move(*value_);
+  }
+
+  std::optional<variant_t> value_;
+};
+
+template <typename Sender>
+struct _value_storage<
+    Sender,
+    std::enable_if_t<
+        std::variant_size_v<typename Sender::template value_types<
+            std::variant,
+            std::tuple>> == 1>> {
+  using variant_t =
+      typename Sender::template value_types<std::variant, std::tuple>;
+  using tuple_t = std::variant_alternative_t<0, variant_t>;
+
+  template <typename... Values>
+  void emplace(Values&&... values) {
+    value_.emplace(std::move(values)...);
+  }
+
+  variant_t get() && {
+    return variant_t{std::in_place_index<0>, std::move(*value_)};
+  }
+
+  std::optional<tuple_t> value_;
+};
+
 template <template <typename...> class Variant, typename... Senders>
 using error_types = typename concat_type_lists_unique_t<
     typename Senders::template error_types<type_list>...,
@@ -103,10 +150,7 @@ struct _element_receiver {
     template <typename... Values>
     void set_value(Values&&... values) noexcept {
       try {
-        std::get<Index>(op_.values_)
-            .emplace(
-                std::in_place_type<std::tuple<Values...>>,
-                std::move(values)...);
+        std::get<Index>(op_.values_).emplace(std::move(values)...);
         op_.element_complete();
       } catch (...) {
         this->set_error(std::current_exception());
@@ -115,7 +159,7 @@ struct _element_receiver {
 
     template <typename Error>
     void set_error(Error&& error) noexcept {
-      if (!op_.doneOrError_.exchange(true, std::memory_order_relaxed)) {
+      if (op_.try_set_done_or_error()) {
         op_.error_.emplace(std::in_place_type<Error>, std::move(error));
         op_.stopSource_.request_stop();
       }
@@ -123,7 +167,7 @@ struct _element_receiver {
     }
 
     void set_done() noexcept {
-      if (!op_.doneOrError_.exchange(true, std::memory_order_relaxed)) {
+      if (op_.try_set_done_or_error()) {
         op_.stopSource_.request_stop();
       }
       op_.element_complete();
@@ -177,28 +221,73 @@ struct _op {
     friend class _element_receiver;
 
     explicit type(Receiver&& receiver, Senders&&... senders)
-      : receiver_(std::move(receiver)),
+      : stopSource_(make_stop_source(receiver)),
+        receiver_(std::move(receiver)),
         ops_(*this, std::move(senders)...) {}
 
     void start() noexcept {
-      stopCallback_.construct(
-          get_stop_token(receiver_), cancel_operation{stopSource_});
+      if constexpr (needs_stop_callback) {
+        stopCallback_.construct(
+            get_stop_token(receiver_), cancel_operation{stopSource_});
+      }
       ops_.start();
     }
 
     private:
+    using stop_token_type = stop_token_type_t<Receiver&>;
+    static constexpr bool stop_possible =
+        !is_stop_never_possible_v<stop_token_type>;
+
+    // An inplace_stop_token from the receiver is chained to directly rather
+    // than registering a callback on it for every when_all().
+    static constexpr bool chain_stop_source =
+        std::is_same_v<stop_token_type, inplace_stop_token>;
+    static constexpr bool needs_stop_callback =
+        stop_possible && !chain_stop_source;
+
+    using stop_source_type = std::conditional_t<
+        chain_stop_source,
+        inplace_stop_child_source,
+        inplace_stop_source>;
+
+    static stop_source_type make_stop_source(Receiver& receiver) noexcept {
+      if constexpr (chain_stop_source) {
+        return stop_source_type{get_stop_token(receiver)};
+      } else {
+        return stop_source_type{};
+      }
+    }
+
+    // Layout of state_: the number of children that have not yet completed
+    // in the high bits and whether any child completed with done or error
+    // in the low bit.
+    static constexpr std::size_t done_or_error_flag = 1;
+    static constexpr std::size_t count_unit = 2;
+
+    // Returns true for the first child to complete with done or error.
+    bool try_set_done_or_error() noexcept {
+      return (state_.fetch_or(done_or_error_flag, std::memory_order_relaxed) &
+              done_or_error_flag) == 0;
+    }
+
     void element_complete() noexcept {
-      if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      if ((state_.fetch_sub(count_unit, std::memory_order_acq_rel) &
+           ~done_or_error_flag) == count_unit) {
         deliver_result();
       }
     }
 
     void deliver_result() noexcept {
-      stopCallback_.destruct();
+      if constexpr (chain_stop_source) {
+        stopSource_.unlink();
+      } else if constexpr (stop_possible) {
+        stopCallback_.destruct();
+      }
 
       if (get_stop_token(receiver_).stop_requested()) {
         unifex::set_done(std::move(receiver_));
-      } else if (doneOrError_.load(std::memory_order_relaxed)) {
+      } else if (
+          state_.load(std::memory_order_relaxed) & done_or_error_flag) {
         if (error_.has_value()) {
           std::visit(
               [this](auto&& error) {
@@ -218,21 +307,23 @@ struct _op {
       try {
         unifex::set_value(
             std::move(receiver_),
-            std::get<Indices>(std::move(values_)).value()...);
+            std::get<Indices>(std::move(values_)).get()...);
       } catch (...) {
         unifex::set_error(std::move(receiver_), std::current_exception());
       }
     }
 
-    std::tuple<std::optional<
-        typename Senders::template value_types<std::variant, std::tuple>>...>
-        values_;
+    struct empty {};
+
+    std::tuple<_value_storage<Senders>...> values_;
     std::optional<error_types<std::variant, Senders...>> error_;
-    std::atomic<std::size_t> refCount_{sizeof...(Senders)};
-    std::atomic<bool> doneOrError_{false};
-    inplace_stop_source stopSource_;
-    UNIFEX_NO_UNIQUE_ADDRESS manual_lifetime<typename stop_token_type_t<
-        Receiver&>::template callback_type<cancel_operation>>
+    std::atomic<std::size_t> state_{sizeof...(Senders) * count_unit};
+    stop_source_type stopSource_;
+    UNIFEX_NO_UNIQUE_ADDRESS std::conditional_t<
+        needs_stop_callback,
+        manual_lifetime<typename stop_token_type::template callback_type<
+            cancel_operation>>,
+        empty>
         stopCallback_;
     Receiver receiver_;
     template<std::size_t Index>
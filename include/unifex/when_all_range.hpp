@@ -0,0 +1,418 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/async_trace.hpp>
+#include <unifex/blocking.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace unifex {
+namespace _when_all_range {
+
+// The type of the value produced by each of the child senders, or void if
+// they produce no value. Children that produce several values produce a
+// std::tuple of them.
+template <typename Sender>
+using element_type = std::remove_cvref_t<typename Sender::
+    template value_types<single_type, single_value_type>::type::type>;
+
+// Storage for the results of each child, allocated up-front.
+//
+// Results are written directly into the final std::vector if the element
+// type is default-constructible, otherwise into a vector of optionals that
+// is unwrapped once all children have completed. Children may complete
+// concurrently, so std::vector<bool>, which packs neighbouring elements into
+// the same word, also takes the latter path.
+template <typename T, typename = void>
+struct _values {
+  explicit _values(std::size_t count) : values_(count) {}
+
+  template <typename... Values>
+  void emplace(std::size_t index, Values&&... values) {
+    values_[index].emplace((Values &&) values...);
+  }
+
+  std::vector<T> take() {
+    std::vector<T> result;
+    result.reserve(values_.size());
+    for (auto& value : values_) {
+      result.push_back(std::move(*value));
+    }
+    return result;
+  }
+
+  std::vector<std::optional<T>> values_;
+};
+
+template <typename T>
+struct _values<
+    T,
+    std::enable_if_t<
+        std::is_default_constructible_v<T> && !std::is_same_v<T, bool>>> {
+  explicit _values(std::size_t count) : values_(count) {}
+
+  template <typename... Values>
+  void emplace(std::size_t index, Values&&... values) {
+    if constexpr (sizeof...(Values) == 1) {
+      values_[index] = T((Values &&) values...);
+    } else {
+      values_[index] = T{(Values &&) values...};
+    }
+  }
+
+  std::vector<T> take() noexcept {
+    return std::move(values_);
+  }
+
+  std::vector<T> values_;
+};
+
+template <>
+struct _values<void, void> {
+  explicit _values(std::size_t) noexcept {}
+
+  void emplace(std::size_t) noexcept {}
+};
+
+struct cancel_operation {
+  inplace_stop_source& stopSource_;
+
+  void operator()() noexcept {
+    stopSource_.request_stop();
+  }
+};
+
+template <typename Sender, typename Receiver>
+struct _op {
+  class type;
+};
+template <typename Sender, typename Receiver>
+using operation = typename _op<Sender, std::remove_cvref_t<Receiver>>::type;
+
+template <typename Sender, typename Receiver>
+struct _element_receiver {
+  class type;
+};
+template <typename Sender, typename Receiver>
+using element_receiver = typename _element_receiver<Sender, Receiver>::type;
+
+template <typename Sender, typename Receiver>
+class _element_receiver<Sender, Receiver>::type final {
+  using element_receiver = type;
+  using operation = typename _op<Sender, Receiver>::type;
+
+ public:
+  explicit type(operation& op, std::size_t index) noexcept
+    : op_(op), index_(index) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) noexcept {
+    try {
+      op_.values_.emplace(index_, (Values &&) values...);
+      op_.element_complete();
+    } catch (...) {
+      this->set_error(std::current_exception());
+    }
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    if (!op_.doneOrError_.exchange(true, std::memory_order_relaxed)) {
+      op_.error_.emplace(
+          std::in_place_type<std::remove_cvref_t<Error>>, (Error &&) error);
+      op_.stopSource_.request_stop();
+    }
+    op_.element_complete();
+  }
+
+  void set_done() noexcept {
+    if (!op_.doneOrError_.exchange(true, std::memory_order_relaxed)) {
+      op_.stopSource_.request_stop();
+    }
+    op_.element_complete();
+  }
+
+  template <
+      typename CPO,
+      typename R,
+      typename... Args,
+      std::enable_if_t<
+          std::conjunction_v<
+              std::negation<is_receiver_cpo<CPO>>,
+              std::is_same<R, element_receiver>,
+              is_callable<CPO, const Receiver&, Args...>>,
+          int> = 0>
+  friend auto tag_invoke(CPO cpo, const R& r, Args&&... args) noexcept(
+      is_nothrow_callable_v<CPO, const Receiver&, Args...>)
+      -> callable_result_t<CPO, const Receiver&, Args...> {
+    return std::move(cpo)(std::as_const(r.get_receiver()), (Args &&) args...);
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const element_receiver& r) noexcept {
+    return r.get_stop_source().get_token();
+  }
+
+  template <typename Func>
+  friend void tag_invoke(
+      tag_t<visit_continuations>, const element_receiver& r, Func&& func) {
+    std::invoke(func, r.get_receiver());
+  }
+
+ private:
+  const Receiver& get_receiver() const noexcept {
+    return op_.receiver_;
+  }
+
+  inplace_stop_source& get_stop_source() const noexcept {
+    return op_.stopSource_;
+  }
+
+  operation& op_;
+  std::size_t index_;
+};
+
+template <template <typename...> class Variant, typename Sender>
+using error_types = typename concat_type_lists_unique_t<
+    typename Sender::template error_types<type_list>,
+    type_list<std::exception_ptr>>::template apply<Variant>;
+
+template <typename Sender, typename Receiver>
+class _op<Sender, Receiver>::type {
+  template <typename Sender2, typename Receiver2>
+  friend struct _element_receiver;
+
+  using element_t = element_type<Sender>;
+  using child_receiver = element_receiver<Sender, Receiver>;
+  using child_op = manual_lifetime<operation_t<Sender, child_receiver>>;
+
+  using stop_token_type = stop_token_type_t<Receiver&>;
+  static constexpr bool stop_possible =
+      !is_stop_never_possible_v<stop_token_type>;
+
+  struct empty {};
+
+ public:
+  template <typename Receiver2>
+  explicit type(std::vector<Sender>&& senders, Receiver2&& receiver)
+    : count_(senders.size()),
+      values_(senders.size()),
+      refCount_(senders.size()),
+      receiver_((Receiver2 &&) receiver),
+      ops_(new child_op[senders.size()]) {
+    std::size_t i = 0;
+    try {
+      for (; i < count_; ++i) {
+        ops_[i].construct_from([&] {
+          return connect(std::move(senders[i]), child_receiver{*this, i});
+        });
+      }
+    } catch (...) {
+      while (i > 0) {
+        ops_[--i].destruct();
+      }
+      throw;
+    }
+  }
+
+  type(type&&) = delete;
+
+  ~type() {
+    for (std::size_t i = 0; i < count_; ++i) {
+      ops_[i].destruct();
+    }
+  }
+
+  void start() noexcept {
+    if (count_ == 0) {
+      deliver_value();
+      return;
+    }
+    if constexpr (stop_possible) {
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_operation{stopSource_});
+    }
+    // The last child to complete may destroy this operation, possibly
+    // before the last call to start() returns, so don't read 'count_'
+    // again once the children have been started.
+    const std::size_t count = count_;
+    for (std::size_t i = 0; i < count; ++i) {
+      unifex::start(ops_[i].get());
+    }
+  }
+
+ private:
+  void element_complete() noexcept {
+    if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      deliver_result();
+    }
+  }
+
+  void deliver_result() noexcept {
+    if constexpr (stop_possible) {
+      stopCallback_.destruct();
+    }
+
+    if (get_stop_token(receiver_).stop_requested()) {
+      unifex::set_done(std::move(receiver_));
+    } else if (doneOrError_.load(std::memory_order_relaxed)) {
+      if (error_.has_value()) {
+        std::visit(
+            [this](auto&& error) {
+              unifex::set_error(std::move(receiver_), (decltype(error))error);
+            },
+            std::move(error_.value()));
+      } else {
+        unifex::set_done(std::move(receiver_));
+      }
+    } else {
+      deliver_value();
+    }
+  }
+
+  void deliver_value() noexcept {
+    try {
+      if constexpr (std::is_void_v<element_t>) {
+        unifex::set_value(std::move(receiver_));
+      } else {
+        unifex::set_value(std::move(receiver_), values_.take());
+      }
+    } catch (...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+    }
+  }
+
+  const std::size_t count_;
+  _values<element_t> values_;
+  std::optional<error_types<std::variant, Sender>> error_;
+  std::atomic<std::size_t> refCount_;
+  std::atomic<bool> doneOrError_{false};
+  inplace_stop_source stopSource_;
+  // No callback is registered if the receiver's stop token can never be
+  // stopped.
+  UNIFEX_NO_UNIQUE_ADDRESS std::conditional_t<
+      stop_possible,
+      manual_lifetime<
+          typename stop_token_type::template callback_type<cancel_operation>>,
+      empty>
+      stopCallback_;
+  Receiver receiver_;
+  // Child operation-states are allocated in a single contiguous array.
+  std::unique_ptr<child_op[]> ops_;
+};
+
+template <typename Sender>
+struct _sender {
+  class type;
+};
+template <typename Sender>
+using sender = typename _sender<std::remove_cvref_t<Sender>>::type;
+
+template <typename Sender>
+class _sender<Sender>::type {
+  using sender = type;
+  using element_t = element_type<Sender>;
+
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = std::conditional_t<
+      std::is_void_v<element_t>,
+      Variant<Tuple<>>,
+      Variant<Tuple<std::vector<non_void_t<element_t>>>>>;
+
+  template <template <typename...> class Variant>
+  using error_types = error_types<Variant, Sender>;
+
+  explicit type(std::vector<Sender>&& senders) noexcept
+    : senders_(std::move(senders)) {}
+
+  template <typename Receiver>
+  operation<Sender, Receiver> connect(Receiver&& receiver) && {
+    return operation<Sender, Receiver>{
+        std::move(senders_), (Receiver &&) receiver};
+  }
+
+ private:
+  // Customise the 'blocking' CPO to combine the blocking-nature
+  // of each of the child operations.
+  friend blocking_kind tag_invoke(tag_t<blocking>, const sender& s) noexcept {
+    bool alwaysInline = true;
+    bool alwaysBlocking = true;
+    bool neverBlocking = false;
+
+    for (const auto& child : s.senders_) {
+      switch (blocking(child)) {
+        case blocking_kind::never:
+          neverBlocking = true;
+          [[fallthrough]];
+        case blocking_kind::maybe:
+          alwaysBlocking = false;
+          [[fallthrough]];
+        case blocking_kind::always:
+          alwaysInline = false;
+          [[fallthrough]];
+        case blocking_kind::always_inline:
+          break;
+      }
+    }
+
+    if (neverBlocking) {
+      return blocking_kind::never;
+    } else if (alwaysInline) {
+      return blocking_kind::always_inline;
+    } else if (alwaysBlocking) {
+      return blocking_kind::always;
+    } else {
+      return blocking_kind::maybe;
+    }
+  }
+
+  std::vector<Sender> senders_;
+};
+
+} // namespace _when_all_range
+
+namespace _when_all_range_cpo {
+  inline constexpr struct _fn {
+    template <typename Sender>
+    _when_all_range::sender<Sender>
+    operator()(std::vector<Sender> senders) const {
+      return _when_all_range::sender<Sender>{std::move(senders)};
+    }
+  } when_all_range{};
+} // namespace _when_all_range_cpo
+
+using _when_all_range_cpo::when_all_range;
+
+} // namespace unifex
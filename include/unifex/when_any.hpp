@@ -0,0 +1,464 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/async_trace.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+#include <unifex/when_all.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace unifex {
+namespace _when_any {
+
+template <
+    template <typename...> class Variant,
+    template <typename...> class Tuple,
+    typename... Senders>
+using value_types = typename concat_type_lists_unique_t<
+    typename Senders::template value_types<type_list, Tuple>...>::
+    template apply<Variant>;
+
+template <template <typename...> class Variant, typename... Senders>
+using error_types = typename concat_type_lists_unique_t<
+    typename Senders::template error_types<decayed_tuple<type_list>::apply>...,
+    type_list<std::exception_ptr>>::template apply<Variant>;
+
+struct cancel_operation {
+  inplace_stop_source& stopSource_;
+
+  void operator()() noexcept {
+    stopSource_.request_stop();
+  }
+};
+
+// State shared by all of the children of a when_any() operation.
+//
+// The first child to produce a value wins and requests that the others
+// stop. The operation completes once every child has completed with:
+// - the winner's value, if any child produced a value; otherwise
+// - done, if a stop was requested from downstream; otherwise
+// - the first error, if any child produced an error; otherwise
+// - done.
+template <typename Receiver, typename Values, typename Errors>
+struct _state {
+  class type;
+};
+
+template <typename Receiver, typename Values, typename Errors>
+class _state<Receiver, Values, Errors>::type {
+  using stop_token_type = stop_token_type_t<Receiver&>;
+  static constexpr bool stop_possible =
+      !is_stop_never_possible_v<stop_token_type>;
+  using stop_callback_type =
+      typename stop_token_type::template callback_type<cancel_operation>;
+
+  // Layout of state_: the number of children that have not yet completed
+  // in the high bits and the flags below in the low bits.
+  static constexpr std::size_t value_flag = 1;
+  static constexpr std::size_t error_flag = 2;
+  static constexpr std::size_t count_unit = 4;
+
+ public:
+  template <typename Receiver2>
+  explicit type(Receiver2&& receiver, std::size_t count)
+    : receiver_((Receiver2 &&) receiver), state_(count * count_unit) {}
+
+  template <typename... Ts>
+  void set_value(Ts&&... values) noexcept {
+    if ((state_.fetch_or(value_flag, std::memory_order_relaxed) &
+         value_flag) == 0) {
+      try {
+        values_.emplace(
+            std::in_place_type<std::tuple<std::remove_cvref_t<Ts>...>>,
+            (Ts &&) values...);
+        stopSource_.request_stop();
+      } catch (...) {
+        set_error(std::current_exception());
+        return;
+      }
+    }
+    complete_one();
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    if ((state_.fetch_or(error_flag, std::memory_order_relaxed) &
+         error_flag) == 0) {
+      error_.emplace(
+          std::in_place_type<std::remove_cvref_t<Error>>, (Error &&) error);
+    }
+    complete_one();
+  }
+
+  void set_done() noexcept {
+    complete_one();
+  }
+
+  const Receiver& get_receiver() const noexcept {
+    return receiver_;
+  }
+
+  inplace_stop_source& get_stop_source() noexcept {
+    return stopSource_;
+  }
+
+ protected:
+  // Returns false if there are no children.
+  bool start_state() noexcept {
+    if (state_.load(std::memory_order_relaxed) == 0) {
+      deliver_result();
+      return false;
+    }
+    if constexpr (stop_possible) {
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_operation{stopSource_});
+    }
+    return true;
+  }
+
+ private:
+  void complete_one() noexcept {
+    const std::size_t oldState =
+        state_.fetch_sub(count_unit, std::memory_order_acq_rel);
+    if (oldState / count_unit == 1) {
+      if constexpr (stop_possible) {
+        stopCallback_.destruct();
+      }
+      deliver_result();
+    }
+  }
+
+  void deliver_result() noexcept {
+    if (values_.has_value()) {
+      try {
+        std::visit(
+            [this](auto&& values) {
+              std::apply(
+                  [this](auto&&... vs) {
+                    unifex::set_value(std::move(receiver_), std::move(vs)...);
+                  },
+                  std::move(values));
+            },
+            std::move(values_.value()));
+      } catch (...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
+      }
+    } else if (get_stop_token(receiver_).stop_requested()) {
+      unifex::set_done(std::move(receiver_));
+    } else if (error_.has_value()) {
+      std::visit(
+          [this](auto&& error) {
+            unifex::set_error(std::move(receiver_), (decltype(error))error);
+          },
+          std::move(error_.value()));
+    } else {
+      unifex::set_done(std::move(receiver_));
+    }
+  }
+
+  struct empty {};
+
+  Receiver receiver_;
+  std::optional<Values> values_;
+  std::optional<Errors> error_;
+  std::atomic<std::size_t> state_;
+  inplace_stop_source stopSource_;
+  UNIFEX_NO_UNIQUE_ADDRESS
+      std::conditional_t<
+          stop_possible,
+          manual_lifetime<stop_callback_type>,
+          empty> stopCallback_;
+};
+
+template <typename State>
+struct _element_receiver {
+  class type;
+};
+template <typename State>
+using element_receiver = typename _element_receiver<State>::type;
+
+template <typename State>
+class _element_receiver<State>::type final {
+  using element_receiver = type;
+
+ public:
+  explicit type(State& state) noexcept : state_(state) {}
+
+  template <typename... Values>
+  void set_value(Values&&... values) noexcept {
+    state_.set_value((Values &&) values...);
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) noexcept {
+    state_.set_error((Error &&) error);
+  }
+
+  void set_done() noexcept {
+    state_.set_done();
+  }
+
+  template <
+      typename CPO,
+      typename R,
+      typename... Args,
+      std::enable_if_t<
+          std::conjunction_v<
+              std::negation<is_receiver_cpo<CPO>>,
+              std::is_same<R, element_receiver>,
+              is_callable<
+                  CPO,
+                  decltype(std::declval<const State&>().get_receiver()),
+                  Args...>>,
+          int> = 0>
+  friend auto tag_invoke(CPO cpo, const R& r, Args&&... args) noexcept(
+      is_nothrow_callable_v<
+          CPO,
+          decltype(std::declval<const State&>().get_receiver()),
+          Args...>)
+      -> callable_result_t<
+          CPO,
+          decltype(std::declval<const State&>().get_receiver()),
+          Args...> {
+    return std::move(cpo)(r.state_.get_receiver(), (Args &&) args...);
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const element_receiver& r) noexcept {
+    return r.state_.get_stop_source().get_token();
+  }
+
+  template <typename Func>
+  friend void tag_invoke(
+      tag_t<visit_continuations>, const element_receiver& r, Func&& func) {
+    std::invoke(func, r.state_.get_receiver());
+  }
+
+ private:
+  State& state_;
+};
+
+template <typename Receiver, typename... Senders>
+using state = typename _state<
+    Receiver,
+    value_types<std::variant, decayed_tuple<std::tuple>::apply, Senders...>,
+    error_types<std::variant, Senders...>>::type;
+
+template <typename Receiver, typename... Senders>
+struct _op {
+  class type;
+};
+template <typename Receiver, typename... Senders>
+using operation =
+    typename _op<std::remove_cvref_t<Receiver>, Senders...>::type;
+
+template <typename Receiver, typename... Senders>
+class _op<Receiver, Senders...>::type final
+  : public state<Receiver, Senders...> {
+  using state_t = state<Receiver, Senders...>;
+
+  template <std::size_t Index>
+  using child_receiver = element_receiver<state_t>;
+
+ public:
+  template <typename Receiver2>
+  explicit type(Receiver2&& receiver, Senders&&... senders)
+    : state_t((Receiver2 &&) receiver, sizeof...(Senders)),
+      ops_(static_cast<state_t&>(*this), std::move(senders)...) {}
+
+  void start() noexcept {
+    if (this->start_state()) {
+      ops_.start();
+    }
+  }
+
+ private:
+  _when_all::operation_tuple<0, child_receiver, Senders...> ops_;
+};
+
+template <typename... Senders>
+struct _sender {
+  class type;
+};
+template <typename... Senders>
+using sender = typename _sender<std::remove_cvref_t<Senders>...>::type;
+
+template <typename... Senders>
+class _sender<Senders...>::type {
+ public:
+  static_assert(sizeof...(Senders) > 0);
+
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = _when_any::value_types<Variant, Tuple, Senders...>;
+
+  template <template <typename...> class Variant>
+  using error_types = _when_any::error_types<Variant, Senders...>;
+
+  template <typename... Senders2>
+  explicit type(Senders2&&... senders) : senders_((Senders2 &&) senders...) {}
+
+  template <typename Receiver>
+  operation<Receiver, Senders...> connect(Receiver&& receiver) && {
+    return std::apply(
+        [&](Senders&&... senders) {
+          return operation<Receiver, Senders...>{
+              (Receiver &&) receiver, std::move(senders)...};
+        },
+        std::move(senders_));
+  }
+
+ private:
+  std::tuple<Senders...> senders_;
+};
+
+template <typename Receiver, typename Sender>
+struct _range_op {
+  class type;
+};
+template <typename Receiver, typename Sender>
+using range_operation =
+    typename _range_op<std::remove_cvref_t<Receiver>, Sender>::type;
+
+template <typename Receiver, typename Sender>
+class _range_op<Receiver, Sender>::type final
+  : public state<Receiver, Sender> {
+  using state_t = state<Receiver, Sender>;
+  using child_op =
+      manual_lifetime<operation_t<Sender, element_receiver<state_t>>>;
+
+ public:
+  template <typename Receiver2>
+  explicit type(Receiver2&& receiver, std::vector<Sender>&& senders)
+    : state_t((Receiver2 &&) receiver, senders.size()),
+      count_(senders.size()),
+      ops_(new child_op[senders.size()]) {
+    std::size_t i = 0;
+    try {
+      for (; i < count_; ++i) {
+        ops_[i].construct_from([&] {
+          return connect(
+              std::move(senders[i]),
+              element_receiver<state_t>{static_cast<state_t&>(*this)});
+        });
+      }
+    } catch (...) {
+      while (i > 0) {
+        ops_[--i].destruct();
+      }
+      throw;
+    }
+  }
+
+  type(type&&) = delete;
+
+  ~type() {
+    for (std::size_t i = 0; i < count_; ++i) {
+      ops_[i].destruct();
+    }
+  }
+
+  void start() noexcept {
+    if (this->start_state()) {
+      // The last child to complete may destroy this operation, possibly
+      // before the last call to start() returns, so don't read 'count_'
+      // again once the children have been started.
+      const std::size_t count = count_;
+      for (std::size_t i = 0; i < count; ++i) {
+        unifex::start(ops_[i].get());
+      }
+    }
+  }
+
+ private:
+  const std::size_t count_;
+  // Child operation-states are allocated in a single contiguous array.
+  std::unique_ptr<child_op[]> ops_;
+};
+
+template <typename Sender>
+struct _range_sender {
+  class type;
+};
+template <typename Sender>
+using range_sender =
+    typename _range_sender<std::remove_cvref_t<Sender>>::type;
+
+template <typename Sender>
+class _range_sender<Sender>::type {
+ public:
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = _when_any::value_types<Variant, Tuple, Sender>;
+
+  template <template <typename...> class Variant>
+  using error_types = _when_any::error_types<Variant, Sender>;
+
+  explicit type(std::vector<Sender>&& senders) noexcept
+    : senders_(std::move(senders)) {}
+
+  template <typename Receiver>
+  range_operation<Receiver, Sender> connect(Receiver&& receiver) && {
+    return range_operation<Receiver, Sender>{
+        (Receiver &&) receiver, std::move(senders_)};
+  }
+
+ private:
+  std::vector<Sender> senders_;
+};
+
+} // namespace _when_any
+
+namespace _when_any_cpo {
+  inline constexpr struct _fn {
+    template <typename... Senders>
+    auto operator()(Senders&&... senders) const
+        -> _when_any::sender<Senders...> {
+      return _when_any::sender<Senders...>{(Senders &&) senders...};
+    }
+  } when_any{};
+
+  inline constexpr struct _range_fn {
+    template <typename Sender>
+    _when_any::range_sender<Sender>
+    operator()(std::vector<Sender> senders) const {
+      return _when_any::range_sender<Sender>{std::move(senders)};
+    }
+  } when_any_range{};
+} // namespace _when_any_cpo
+
+using _when_any_cpo::when_any;
+using _when_any_cpo::when_any_range;
+
+} // namespace unifex
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <unifex/async_trace.hpp>
 #include <unifex/get_allocator.hpp>
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
@@ -37,6 +38,12 @@ struct _receiver_wrapper {
       return *r.val_;
     }
 
+    template <typename Func>
+    friend void tag_invoke(
+        tag_t<visit_continuations>, const type &r, Func &&func) {
+      visit_continuations(r.receiver_, (Func &&) func);
+    }
+
     template <typename OtherCPO, typename... Args>
     friend auto tag_invoke(OtherCPO cpo, const type &r, Args &&... args)
         noexcept(is_nothrow_callable_v<OtherCPO, const Receiver &, Args...>)
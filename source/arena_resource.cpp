@@ -0,0 +1,152 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/arena_resource.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace unifex {
+
+// Each allocation is immediately preceded by a pointer to the chunk it was
+// allocated from so that deallocate() can find the chunk.
+struct arena_resource::chunk {
+  explicit chunk(arena_resource* owner, std::size_t size) noexcept
+    : owner_(owner), size_(size) {}
+
+  char* begin() noexcept {
+    return reinterpret_cast<char*>(this + 1);
+  }
+
+  char* end() noexcept {
+    return begin() + size_;
+  }
+
+  // Number of live allocations from this chunk, offset by the number of
+  // allocations made while it was the current chunk. While the chunk is
+  // current, this only ever decreases (modulo 2^N) and only becomes a true
+  // count once the chunk is retired. The deallocation that brings it back
+  // to zero after retirement recycles the chunk.
+  std::atomic<std::size_t> refCount_{0};
+  arena_resource* const owner_;
+  const std::size_t size_;
+  chunk* next_ = nullptr;
+  chunk* nextAll_ = nullptr;
+};
+
+arena_resource::~arena_resource() {
+  assert(
+      current_ == nullptr ||
+      current_->refCount_.load(std::memory_order_relaxed) + allocationCount_ ==
+          0);
+
+  chunk* c = allChunks_;
+  while (c != nullptr) {
+    chunk* next = c->nextAll_;
+    c->~chunk();
+    ::operator delete(static_cast<void*>(c));
+    c = next;
+  }
+}
+
+void* arena_resource::allocate(std::size_t bytes, std::size_t alignment) {
+  alignment = std::max(alignment, alignof(chunk*));
+  auto addr = reinterpret_cast<std::uintptr_t>(next_) + sizeof(chunk*);
+  addr = (addr + alignment - 1) & ~(alignment - 1);
+  if (current_ == nullptr ||
+      bytes > reinterpret_cast<std::uintptr_t>(end_) - addr ||
+      addr > reinterpret_cast<std::uintptr_t>(end_)) {
+    return allocate_slow(bytes, alignment);
+  }
+
+  char* p = reinterpret_cast<char*>(addr);
+  std::memcpy(p - sizeof(chunk*), &current_, sizeof(chunk*));
+  next_ = p + bytes;
+  ++allocationCount_;
+  return p;
+}
+
+void* arena_resource::allocate_slow(std::size_t bytes, std::size_t alignment) {
+  chunk* c = acquire_chunk(bytes + alignment + sizeof(chunk*));
+  retire_current();
+  current_ = c;
+  next_ = c->begin();
+  end_ = c->end();
+  return allocate(bytes, alignment);
+}
+
+void arena_resource::deallocate(void* p) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+  chunk* c;
+  std::memcpy(&c, static_cast<char*>(p) - sizeof(chunk*), sizeof(chunk*));
+  if (c->refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    c->owner_->recycle(c);
+  }
+}
+
+void arena_resource::retire_current() noexcept {
+  chunk* c = std::exchange(current_, nullptr);
+  if (c == nullptr) {
+    return;
+  }
+  next_ = nullptr;
+  end_ = nullptr;
+
+  // Hand ownership of the chunk over to its outstanding allocations.
+  const std::size_t count = std::exchange(allocationCount_, 0);
+  if (c->refCount_.fetch_add(count, std::memory_order_acq_rel) + count == 0) {
+    // Everything allocated from the chunk has already been freed.
+    c->next_ = spareChunks_;
+    spareChunks_ = c;
+  }
+}
+
+arena_resource::chunk* arena_resource::acquire_chunk(std::size_t minSize) {
+  if (spareChunks_ == nullptr &&
+      recycledChunks_.load(std::memory_order_relaxed) != nullptr) {
+    spareChunks_ = recycledChunks_.exchange(nullptr, std::memory_order_acquire);
+  }
+
+  for (chunk** link = &spareChunks_; *link != nullptr; link = &(*link)->next_) {
+    chunk* c = *link;
+    if (c->size_ >= minSize) {
+      *link = c->next_;
+      c->next_ = nullptr;
+      return c;
+    }
+  }
+
+  const std::size_t size = std::max(chunkSize_, minSize);
+  void* storage = ::operator new(sizeof(chunk) + size);
+  chunk* c = ::new (storage) chunk{this, size};
+  c->nextAll_ = allChunks_;
+  allChunks_ = c;
+  return c;
+}
+
+void arena_resource::recycle(chunk* c) noexcept {
+  chunk* oldHead = recycledChunks_.load(std::memory_order_relaxed);
+  do {
+    c->next_ = oldHead;
+  } while (!recycledChunks_.compare_exchange_weak(
+      oldHead, c, std::memory_order_release, std::memory_order_relaxed));
+}
+
+} // namespace unifex
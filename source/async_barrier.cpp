@@ -0,0 +1,56 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_barrier.hpp>
+
+#include <cassert>
+
+namespace unifex {
+
+async_barrier::async_barrier(std::ptrdiff_t expected) noexcept
+  : expected_(expected), remaining_(expected) {
+  assert(expected > 0);
+}
+
+async_barrier::~async_barrier() {
+  // Check that nobody is still waiting.
+  assert(waiters_.load(std::memory_order_relaxed) == nullptr);
+}
+
+void async_barrier::arrive() noexcept {
+  if (remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  // Last to arrive. Every waiter in this phase pushed itself before
+  // arriving, and none can arrive for the next phase until resumed.
+  auto *waiters = waiters_.exchange(nullptr, std::memory_order_acquire);
+  remaining_.store(expected_, std::memory_order_release);
+  _async_wait::resume_all(waiters);
+}
+
+bool async_barrier::arrive_and_enqueue(
+    void *self, _async_wait::waiter_base *waiter) noexcept {
+  auto &barrier = *static_cast<async_barrier *>(self);
+  auto *oldHead = barrier.waiters_.load(std::memory_order_relaxed);
+  do {
+    waiter->next_ = oldHead;
+  } while (!barrier.waiters_.compare_exchange_weak(
+      oldHead, waiter, std::memory_order_release, std::memory_order_relaxed));
+  barrier.arrive();
+  return true;
+}
+
+} // namespace unifex
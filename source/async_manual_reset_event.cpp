@@ -0,0 +1,61 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_manual_reset_event.hpp>
+
+#include <cassert>
+
+namespace unifex {
+
+async_manual_reset_event::async_manual_reset_event(
+    bool startSignalled) noexcept
+  : state_(startSignalled ? signalled_value() : nullptr) {}
+
+async_manual_reset_event::~async_manual_reset_event() {
+  // Check that nobody is still waiting.
+  [[maybe_unused]] void *state = state_.load(std::memory_order_relaxed);
+  assert(state == nullptr || state == signalled_value());
+}
+
+void async_manual_reset_event::set() noexcept {
+  void *const oldState =
+      state_.exchange(signalled_value(), std::memory_order_acq_rel);
+  if (oldState != signalled_value()) {
+    _async_wait::resume_all(static_cast<_async_wait::waiter_base *>(oldState));
+  }
+}
+
+void async_manual_reset_event::reset() noexcept {
+  void *oldState = signalled_value();
+  (void)state_.compare_exchange_strong(
+      oldState, nullptr, std::memory_order_relaxed);
+}
+
+bool async_manual_reset_event::try_enqueue(
+    void *self, _async_wait::waiter_base *waiter) noexcept {
+  auto &event = *static_cast<async_manual_reset_event *>(self);
+  void *const signalled = event.signalled_value();
+  void *oldState = event.state_.load(std::memory_order_acquire);
+  do {
+    if (oldState == signalled) {
+      return false;
+    }
+    waiter->next_ = static_cast<_async_wait::waiter_base *>(oldState);
+  } while (!event.state_.compare_exchange_weak(
+      oldState, waiter, std::memory_order_release, std::memory_order_acquire));
+  return true;
+}
+
+} // namespace unifex
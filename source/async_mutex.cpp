@@ -16,29 +16,10 @@
 
 #include <unifex/async_mutex.hpp>
 
-#include <cassert>
-
 namespace unifex {
 
-async_mutex::async_mutex() noexcept : atomicQueue_(false) {}
+async_mutex::async_mutex() noexcept : semaphore_(1) {}
 
 async_mutex::~async_mutex() {}
 
-bool async_mutex::try_enqueue(waiter_base *base) noexcept {
-  return atomicQueue_.enqueue_or_mark_active(base);
-}
-
-void async_mutex::unlock() noexcept {
-  if (pendingQueue_.empty()) {
-    auto newWaiters = atomicQueue_.try_mark_inactive_or_dequeue_all();
-    if (newWaiters.empty()) {
-      return;
-    }
-    pendingQueue_ = std::move(newWaiters);
-  }
-
-  waiter_base *item = pendingQueue_.pop_front();
-  item->resume_(item);
-}
-
 } // namespace unifex
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_semaphore.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace unifex {
+
+async_semaphore::async_semaphore(std::ptrdiff_t initialPermits) noexcept
+  : initialPermits_(initialPermits),
+    available_(initialPermits),
+    atomicQueue_(false) {}
+
+async_semaphore::~async_semaphore() {
+  assert(waiterCount_.load(std::memory_order_relaxed) == 0);
+}
+
+void async_semaphore::release_to_waiters() noexcept {
+  // Pairs with the fence in process(): either the thread processing the
+  // queue sees these permits before marking it inactive, or we take over.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (atomicQueue_.try_mark_active()) {
+    process();
+  }
+}
+
+void async_semaphore::hand_off(std::ptrdiff_t count) noexcept {
+  handedOff_.fetch_add(count, std::memory_order_release);
+  release_to_waiters();
+}
+
+void async_semaphore::enqueue(waiter_base *waiter) noexcept {
+  waiterCount_.fetch_add(1, std::memory_order_seq_cst);
+  if (atomicQueue_.enqueue_or_mark_active(waiter)) {
+    return;
+  }
+  if (waiter->stopRequested_.load(std::memory_order_relaxed)) {
+    // The stop-callback ran before the waiter was queued.
+    stopRequestCount_.fetch_add(1, std::memory_order_relaxed);
+  }
+  pendingQueue_.push_back(waiter);
+  process();
+}
+
+void async_semaphore::request_stop(waiter_base *waiter) noexcept {
+  waiter->stopRequested_.store(true, std::memory_order_relaxed);
+  stopRequestCount_.fetch_add(1, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (atomicQueue_.try_mark_active()) {
+    process();
+  }
+}
+
+void async_semaphore::process() noexcept {
+  waiter_queue completed;
+  for (;;) {
+    const bool stopRequested =
+        stopRequestCount_.exchange(0, std::memory_order_acquire) != 0;
+    std::ptrdiff_t handedOff =
+        handedOff_.exchange(0, std::memory_order_acquire);
+    add_pending(atomicQueue_.dequeue_all(), completed);
+    if (stopRequested) {
+      remove_stopped(completed, handedOff);
+    }
+    grant_pending(completed, handedOff);
+
+    const bool blocked = !pendingQueue_.empty();
+    if (handedOff != 0) {
+      // There is no one left to hand these permits to.
+      assert(!blocked);
+      available_.fetch_add(handedOff, std::memory_order_release);
+    }
+    auto newWaiters = atomicQueue_.try_mark_inactive_or_dequeue_all();
+    if (!newWaiters.empty()) {
+      add_pending(std::move(newWaiters), completed);
+      continue;
+    }
+
+    // Permits released or stop requested concurrently with marking the
+    // queue inactive may not have been able to take over processing.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const bool moreWork =
+        stopRequestCount_.load(std::memory_order_relaxed) != 0 ||
+        handedOff_.load(std::memory_order_relaxed) != 0 ||
+        (blocked && available_.load(std::memory_order_relaxed) > 0);
+    if (!moreWork || !atomicQueue_.try_mark_active()) {
+      break;
+    }
+  }
+
+  while (!completed.empty()) {
+    waiter_base *item = completed.pop_front();
+    waiterCount_.fetch_sub(1, std::memory_order_relaxed);
+    item->resume_(item);
+  }
+}
+
+void async_semaphore::add_pending(
+    waiter_queue waiters, waiter_queue &completed) noexcept {
+  while (!waiters.empty()) {
+    waiter_base *item = waiters.pop_front();
+    if (item->stopRequested_.load(std::memory_order_relaxed)) {
+      completed.push_back(item);
+    } else {
+      pendingQueue_.push_back(item);
+    }
+  }
+}
+
+void async_semaphore::remove_stopped(
+    waiter_queue &completed, std::ptrdiff_t &handedOff) noexcept {
+  waiter_queue remaining;
+  while (!pendingQueue_.empty()) {
+    waiter_base *item = pendingQueue_.pop_front();
+    if (item->stopRequested_.load(std::memory_order_relaxed)) {
+      // Pass the permits reserved for the waiter on to the ones behind it.
+      handedOff += item->reserved_;
+      item->reserved_ = 0;
+      completed.push_back(item);
+    } else {
+      remaining.push_back(item);
+    }
+  }
+  pendingQueue_ = std::move(remaining);
+}
+
+void async_semaphore::grant_pending(
+    waiter_queue &completed, std::ptrdiff_t &handedOff) noexcept {
+  while (!pendingQueue_.empty()) {
+    waiter_base *item = pendingQueue_.pop_front();
+    // Take permits handed off by release() before available ones.
+    std::ptrdiff_t taken = std::min(handedOff, item->remaining_);
+    handedOff -= taken;
+    if (taken < item->remaining_) {
+      taken += reserve(item->remaining_ - taken);
+    }
+    item->remaining_ -= taken;
+    item->reserved_ += taken;
+    if (item->remaining_ != 0) {
+      pendingQueue_.push_front(item);
+      return;
+    }
+    item->acquired_ = true;
+    completed.push_back(item);
+  }
+}
+
+std::ptrdiff_t async_semaphore::reserve(std::ptrdiff_t count) noexcept {
+  auto available = available_.load(std::memory_order_relaxed);
+  std::ptrdiff_t taken;
+  do {
+    if (available <= 0) {
+      return 0;
+    }
+    taken = std::min(available, count);
+  } while (!available_.compare_exchange_weak(
+      available, available - taken, std::memory_order_acquire,
+      std::memory_order_relaxed));
+  return taken;
+}
+
+} // namespace unifex
@@ -23,9 +23,33 @@
 
 namespace unifex {
 
+namespace {
+
+// Marks a slot claimed by request_stop(), after which it is never reused.
+inplace_stop_callback_base* claimed_slot() noexcept {
+  return reinterpret_cast<inplace_stop_callback_base*>(std::uintptr_t(1));
+}
+
+// Spreads threads registering against the same source across its slots.
+std::size_t this_thread_slot() noexcept {
+  static std::atomic<std::size_t> nextSlot{0};
+  thread_local const std::size_t slot =
+      nextSlot.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+} // namespace
+
 inplace_stop_source::~inplace_stop_source() {
   assert((state_.load(std::memory_order_relaxed) & locked_flag) == 0);
 #ifndef NDEBUG
+  for (auto& slot : slots_) {
+    auto* cb = slot.load(std::memory_order_relaxed);
+    if (cb != nullptr && cb != claimed_slot()) {
+      printf("dangling inplace_stop_callback: %s\n", typeid(*cb).name());
+      fflush(stdout);
+    }
+  }
   for (auto* cb = callbacks_; cb != nullptr; cb = cb->next_) {
     printf("dangling inplace_stop_callback: %s\n", typeid(*cb).name());
     fflush(stdout);
@@ -53,15 +77,7 @@ bool inplace_stop_source::request_stop() noexcept {
     // unlock()
     state_.store(stop_requested_flag, std::memory_order_release);
 
-    bool removedDuringCallback = false;
-    callback->removedDuringCallback_ = &removedDuringCallback;
-
-    callback->execute();
-
-    if (!removedDuringCallback) {
-      callback->removedDuringCallback_ = nullptr;
-      callback->callbackCompleted_.store(true, std::memory_order_release);
-    }
+    execute_callback(callback);
 
     lock();
   }
@@ -69,9 +85,31 @@ bool inplace_stop_source::request_stop() noexcept {
   // unlock()
   state_.store(stop_requested_flag, std::memory_order_release);
 
+  // Claiming a slot prevents it from being registered again, and tells a
+  // concurrent remove_callback() that its callback is executing.
+  for (auto& slot : slots_) {
+    auto* callback = slot.exchange(claimed_slot(), std::memory_order_seq_cst);
+    if (callback != nullptr) {
+      execute_callback(callback);
+    }
+  }
+
   return false;
 }
 
+void inplace_stop_source::execute_callback(
+    inplace_stop_callback_base* callback) noexcept {
+  bool removedDuringCallback = false;
+  callback->removedDuringCallback_ = &removedDuringCallback;
+
+  callback->execute();
+
+  if (!removedDuringCallback) {
+    callback->removedDuringCallback_ = nullptr;
+    callback->callbackCompleted_.store(true, std::memory_order_release);
+  }
+}
+
 std::uint8_t inplace_stop_source::lock() noexcept {
   spin_wait spin;
   auto oldState = state_.load(std::memory_order_relaxed);
@@ -112,7 +150,9 @@ bool inplace_stop_source::try_lock_unless_stop_requested(
   } while (!state_.compare_exchange_weak(
       oldState,
       setStopRequested ? (locked_flag | stop_requested_flag) : locked_flag,
-      std::memory_order_acq_rel,
+      // Sequentially consistent so that try_add_callback() either
+      // sees the stop request or request_stop() sees its slot.
+      std::memory_order_seq_cst,
       std::memory_order_relaxed));
 
   // Lock acquired successfully
@@ -121,6 +161,60 @@ bool inplace_stop_source::try_lock_unless_stop_requested(
 
 bool inplace_stop_source::try_add_callback(
     inplace_stop_callback_base* callback) noexcept {
+  if (!try_add_local_callback(callback)) {
+    return false;
+  }
+  if (parent_ != nullptr) {
+    static_cast<inplace_stop_child_source*>(this)->link_to_parent();
+  }
+  return true;
+}
+
+bool inplace_stop_source::try_add_local_callback(
+    inplace_stop_callback_base* callback) noexcept {
+  if (stop_requested()) {
+    return false;
+  }
+
+  const std::size_t first = this_thread_slot();
+  for (std::size_t i = 0; i < slot_count; ++i) {
+    auto& slot = slots_[(first + i) % slot_count];
+    auto* current = slot.load(std::memory_order_relaxed);
+    if (current == nullptr &&
+        slot.compare_exchange_strong(
+            current,
+            callback,
+            std::memory_order_seq_cst,
+            std::memory_order_relaxed)) {
+      callback->slot_ = &slot;
+      if ((state_.load(std::memory_order_seq_cst) & stop_requested_flag) ==
+          0) {
+        return true;
+      }
+
+      // Stop was requested concurrently. Take the callback back unless
+      // request_stop() has already claimed it for execution.
+      current = callback;
+      if (slot.compare_exchange_strong(
+              current,
+              nullptr,
+              std::memory_order_acq_rel,
+              std::memory_order_acquire)) {
+        callback->slot_ = nullptr;
+        return false;
+      }
+      return true;
+    }
+    if (current == claimed_slot()) {
+      return false;
+    }
+  }
+
+  return try_add_callback_to_list(callback);
+}
+
+bool inplace_stop_source::try_add_callback_to_list(
+    inplace_stop_callback_base* callback) noexcept {
   if (!try_lock_unless_stop_requested(false)) {
     return false;
   }
@@ -139,6 +233,19 @@ bool inplace_stop_source::try_add_callback(
 
 void inplace_stop_source::remove_callback(
     inplace_stop_callback_base* callback) noexcept {
+  if (callback->slot_ != nullptr) {
+    auto* expected = callback;
+    if (!callback->slot_->compare_exchange_strong(
+            expected,
+            nullptr,
+            std::memory_order_release,
+            std::memory_order_acquire)) {
+      // Claimed by request_stop().
+      wait_for_callback(callback);
+    }
+    return;
+  }
+
   auto oldState = lock();
 
   if (callback->prevPtr_ != nullptr) {
@@ -151,22 +258,74 @@ void inplace_stop_source::remove_callback(
     unlock(oldState);
   } else {
     unlock(oldState);
+    wait_for_callback(callback);
+  }
+}
 
-    // Callback has either already been executed or is
-    // currently executing on another thread.
-    if (std::this_thread::get_id() == notifyingThreadId_) {
-      if (callback->removedDuringCallback_ != nullptr) {
-        *callback->removedDuringCallback_ = true;
-      }
-    } else {
-      // Concurrently executing on another thread.
-      // Wait until the other thread finishes executing the callback.
-      spin_wait spin;
-      while (!callback->callbackCompleted_.load(std::memory_order_acquire)) {
-        spin.wait();
-      }
+void inplace_stop_source::wait_for_callback(
+    inplace_stop_callback_base* callback) noexcept {
+  // Callback has either already been executed or is
+  // currently executing on another thread.
+  if (std::this_thread::get_id() == notifyingThreadId_) {
+    if (callback->removedDuringCallback_ != nullptr) {
+      *callback->removedDuringCallback_ = true;
+    }
+  } else {
+    // Concurrently executing on another thread.
+    // Wait until the other thread finishes executing the callback.
+    spin_wait spin;
+    while (!callback->callbackCompleted_.load(std::memory_order_acquire)) {
+      spin.wait();
     }
   }
 }
 
+inplace_stop_child_source::inplace_stop_child_source(
+    inplace_stop_token parent) noexcept
+  : link_(*this, parent.source_) {
+  parent_ = parent.source_;
+}
+
+inplace_stop_child_source::~inplace_stop_child_source() {
+  unlink();
+}
+
+void inplace_stop_child_source::unlink() noexcept {
+  if (linked_.load(std::memory_order_acquire)) {
+    link_.detach();
+  }
+  parent_ = nullptr;
+}
+
+void inplace_stop_child_source::link_to_parent() noexcept {
+  if (linked_.load(std::memory_order_relaxed) ||
+      linked_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  if (!link_.attach()) {
+    // Stop was already requested on the parent.
+    request_stop();
+  }
+}
+
+bool inplace_stop_child_source::link::attach() noexcept {
+  if (!source_->try_add_callback(this)) {
+    source_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void inplace_stop_child_source::link::detach() noexcept {
+  if (source_ != nullptr) {
+    source_->remove_callback(this);
+    source_ = nullptr;
+  }
+}
+
+void inplace_stop_child_source::link::execute() noexcept {
+  child_.request_stop();
+}
+
 } // namespace unifex
@@ -36,6 +36,32 @@ void context::run() {
   }
 }
 
+void context::run_until(const bool& complete) {
+  std::unique_lock lock{mutex_};
+  while (!complete) {
+    if (head_ == nullptr) {
+      cv_.wait(lock);
+      continue;
+    }
+    auto* task = head_;
+    head_ = task->next_;
+    if (head_ == nullptr) {
+      tail_ = nullptr;
+    }
+    lock.unlock();
+    task->execute();
+    lock.lock();
+  }
+}
+
+void context::set_complete(bool& complete) {
+  std::lock_guard lock{mutex_};
+  complete = true;
+  // Another thread calling run() may have executed the task that completes
+  // a sync_wait(), so wake every thread waiting on the loop.
+  cv_.notify_all();
+}
+
 void context::stop() {
   std::unique_lock lock{mutex_};
   stop_ = true;
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/pool_allocator.hpp>
+
+#include <unifex/detail/hardware_interference_size.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+
+namespace unifex {
+namespace _pool {
+namespace {
+  // Block sizes for each size-class. Spaced so that no more than ~25% of
+  // a block is wasted for any request size.
+  constexpr std::size_t class_sizes[] = {
+      16,   32,   48,   64,   80,   96,   112,  128,
+      160,  192,  224,  256,  320,  384,  448,  512,
+      640,  768,  896,  1024, 1280, 1536, 1792, 2048};
+  constexpr std::size_t class_count = std::size(class_sizes);
+  constexpr std::size_t granularity = 16;
+
+  static_assert(class_sizes[class_count - 1] == max_pooled_size);
+  static_assert(granularity % max_pooled_alignment == 0);
+
+  struct size_class_table {
+    std::uint8_t index[max_pooled_size / granularity + 1];
+  };
+
+  constexpr size_class_table make_size_class_table() noexcept {
+    size_class_table table{};
+    std::size_t c = 0;
+    for (std::size_t i = 0; i <= max_pooled_size / granularity; ++i) {
+      while (class_sizes[c] < i * granularity) {
+        ++c;
+      }
+      table.index[i] = static_cast<std::uint8_t>(c);
+    }
+    return table;
+  }
+
+  constexpr size_class_table sizeClassTable = make_size_class_table();
+
+  std::size_t size_class_of(std::size_t bytes) noexcept {
+    return sizeClassTable.index[(bytes + granularity - 1) / granularity];
+  }
+
+  bool is_pooled(std::size_t bytes, std::size_t alignment) noexcept {
+    return bytes <= max_pooled_size && alignment <= max_pooled_alignment;
+  }
+
+  // Blocks are carved out of slabs that are aligned to their size so that
+  // the owning cache of any block can be found by masking its address.
+  constexpr std::size_t slab_size = 64 * 1024;
+  constexpr std::size_t slab_header_size = 64;
+
+  // Maximum number of blocks owned by another thread that are accumulated
+  // before being handed back to their owner.
+  constexpr std::size_t batch_size = 16;
+
+  struct free_block {
+    free_block* next;
+  };
+
+  struct thread_cache;
+
+  struct slab_header {
+    thread_cache* owner;
+  };
+  static_assert(sizeof(slab_header) <= slab_header_size);
+
+  slab_header* slab_of(void* p) noexcept {
+    return reinterpret_cast<slab_header*>(
+        reinterpret_cast<std::uintptr_t>(p) & ~(slab_size - 1));
+  }
+
+  struct outgoing_batch {
+    thread_cache* owner = nullptr;
+    free_block* head = nullptr;
+    free_block* tail = nullptr;
+    std::size_t count = 0;
+  };
+
+  struct thread_cache {
+    void* allocate(std::size_t sizeClass) {
+      free_block* block = freeList_[sizeClass];
+      if (block == nullptr) {
+        // Reclaim, in one go, everything other threads have handed back.
+        if (remoteFree_[sizeClass].load(std::memory_order_relaxed) ==
+            nullptr) {
+          return carve(class_sizes[sizeClass]);
+        }
+        block = remoteFree_[sizeClass].exchange(
+            nullptr, std::memory_order_acquire);
+        assert(block != nullptr);
+      }
+      freeList_[sizeClass] = block->next;
+      return block;
+    }
+
+    void deallocate_local(void* p, std::size_t sizeClass) noexcept {
+      auto* block = static_cast<free_block*>(p);
+      block->next = freeList_[sizeClass];
+      freeList_[sizeClass] = block;
+    }
+
+    void deallocate_foreign(
+        thread_cache* owner, void* p, std::size_t sizeClass) noexcept {
+      auto* block = static_cast<free_block*>(p);
+      auto& batch = outgoing_[sizeClass];
+      if (batch.owner != owner) {
+        flush(sizeClass);
+        block->next = nullptr;
+        batch.owner = owner;
+        batch.head = block;
+        batch.tail = block;
+        batch.count = 1;
+      } else {
+        block->next = batch.head;
+        batch.head = block;
+        ++batch.count;
+      }
+      if (batch.count == batch_size) {
+        flush(sizeClass);
+      }
+    }
+
+    // Called by other threads to return a chain of blocks to this cache.
+    void push_remote(
+        free_block* head, free_block* tail, std::size_t sizeClass) noexcept {
+      auto& list = remoteFree_[sizeClass];
+      free_block* oldHead = list.load(std::memory_order_relaxed);
+      do {
+        tail->next = oldHead;
+      } while (!list.compare_exchange_weak(
+          oldHead,
+          head,
+          std::memory_order_release,
+          std::memory_order_relaxed));
+    }
+
+    void flush(std::size_t sizeClass) noexcept {
+      auto& batch = outgoing_[sizeClass];
+      if (batch.count != 0) {
+        batch.owner->push_remote(batch.head, batch.tail, sizeClass);
+        batch = outgoing_batch{};
+      }
+    }
+
+    void flush_all() noexcept {
+      for (std::size_t c = 0; c < class_count; ++c) {
+        flush(c);
+      }
+    }
+
+    thread_cache* nextAbandoned_ = nullptr;
+
+  private:
+    void* carve(std::size_t size) {
+      if (static_cast<std::size_t>(bumpEnd_ - bumpNext_) < size) {
+        // The remainder of the current slab is discarded.
+        void* slab = ::operator new(slab_size, std::align_val_t{slab_size});
+        ::new (slab) slab_header{this};
+        bumpNext_ = static_cast<char*>(slab) + slab_header_size;
+        bumpEnd_ = static_cast<char*>(slab) + slab_size;
+      }
+      void* p = bumpNext_;
+      bumpNext_ += size;
+      return p;
+    }
+
+    ////////
+    // Data only accessed by the owning thread.
+
+    free_block* freeList_[class_count] = {};
+    outgoing_batch outgoing_[class_count];
+    char* bumpNext_ = nullptr;
+    char* bumpEnd_ = nullptr;
+
+    ////////
+    // Data written by other threads returning blocks to this cache.
+
+    alignas(hardware_destructive_interference_size)
+        std::atomic<free_block*> remoteFree_[class_count] = {};
+  };
+
+  struct registry {
+    std::mutex mutex_;
+
+    // Caches released by threads that have exited, waiting to be adopted
+    // by new threads.
+    thread_cache* abandoned_ = nullptr;
+
+    // Used for allocations made by threads after their own cache has been
+    // released (ie. from other thread_local destructors).
+    // Only accessed with mutex_ held.
+    thread_cache shared_;
+  };
+
+  registry& get_registry() noexcept {
+    // Intentionally leaked so that it remains usable by threads that are
+    // still running during static destruction.
+    static registry* r = new registry;
+    return *r;
+  }
+
+  thread_local thread_cache* currentCache = nullptr;
+  thread_local bool currentCacheReleased = false;
+
+  struct thread_cache_releaser {
+    ~thread_cache_releaser() {
+      thread_cache* cache = currentCache;
+      currentCache = nullptr;
+      currentCacheReleased = true;
+      if (cache != nullptr) {
+        cache->flush_all();
+        auto& r = get_registry();
+        std::lock_guard lk{r.mutex_};
+        cache->nextAbandoned_ = r.abandoned_;
+        r.abandoned_ = cache;
+      }
+    }
+  };
+  thread_local thread_cache_releaser currentCacheReleaser;
+
+  // Returns nullptr if the calling thread has already released its cache
+  // or if a new cache could not be allocated.
+  thread_cache* get_current_cache() noexcept {
+    if (currentCache != nullptr) {
+      return currentCache;
+    }
+    if (currentCacheReleased) {
+      return nullptr;
+    }
+
+    thread_cache* cache = nullptr;
+    {
+      auto& r = get_registry();
+      std::lock_guard lk{r.mutex_};
+      cache = r.abandoned_;
+      if (cache != nullptr) {
+        r.abandoned_ = cache->nextAbandoned_;
+        cache->nextAbandoned_ = nullptr;
+      }
+    }
+    if (cache == nullptr) {
+      cache = new (std::nothrow) thread_cache;
+      if (cache == nullptr) {
+        return nullptr;
+      }
+    }
+
+    // Odr-use the releaser so that it gets constructed and its destructor
+    // runs on thread exit.
+    (void)&currentCacheReleaser;
+    currentCache = cache;
+    return cache;
+  }
+} // namespace
+
+void* allocate(std::size_t bytes, std::size_t alignment) {
+  if (!is_pooled(bytes, alignment)) {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(bytes, std::align_val_t{alignment});
+    }
+    return ::operator new(bytes);
+  }
+
+  const std::size_t sizeClass = size_class_of(bytes == 0 ? 1 : bytes);
+  if (thread_cache* cache = get_current_cache()) {
+    return cache->allocate(sizeClass);
+  }
+
+  auto& r = get_registry();
+  std::lock_guard lk{r.mutex_};
+  return r.shared_.allocate(sizeClass);
+}
+
+void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+
+  if (!is_pooled(bytes, alignment)) {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, bytes, std::align_val_t{alignment});
+    } else {
+      ::operator delete(p, bytes);
+    }
+    return;
+  }
+
+  const std::size_t sizeClass = size_class_of(bytes == 0 ? 1 : bytes);
+  thread_cache* owner = slab_of(p)->owner;
+  if (thread_cache* cache = get_current_cache()) {
+    if (cache == owner) {
+      cache->deallocate_local(p, sizeClass);
+    } else {
+      cache->deallocate_foreign(owner, p, sizeClass);
+    }
+  } else {
+    auto* block = static_cast<free_block*>(p);
+    owner->push_remote(block, block, sizeClass);
+  }
+}
+
+} // namespace _pool
+} // namespace unifex
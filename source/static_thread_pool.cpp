@@ -17,6 +17,13 @@
 
 namespace unifex {
 namespace _static_thread_pool {
+  namespace {
+    // The pool and worker arena of the pool thread that is currently running
+    // on this thread, if any.
+    thread_local const context* currentPool = nullptr;
+    thread_local arena_resource* currentArena = nullptr;
+  } // namespace
+
   context::context()
     : context(std::thread::hardware_concurrency()) {}
 
@@ -50,6 +57,9 @@ namespace _static_thread_pool {
   }
 
   void context::run(std::uint32_t index) noexcept {
+    currentPool = this;
+    currentArena = &threadStates_[index].arena_;
+
     while (true) {
       task_base* task = nullptr;
       for (std::uint32_t i = 0; i < threadCount_; ++i) {
@@ -75,6 +85,14 @@ namespace _static_thread_pool {
     }
   }
 
+  void* context::allocate(std::size_t bytes, std::size_t alignment) {
+    if (currentPool == this) {
+      return currentArena->allocate(bytes, alignment);
+    }
+    std::lock_guard lk{sharedArenaMutex_};
+    return sharedArena_.allocate(bytes, alignment);
+  }
+
   void context::join() noexcept {
     for (auto& t : threads_) {
       t.join();
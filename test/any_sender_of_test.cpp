@@ -0,0 +1,193 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/any_scheduler.hpp>
+#include <unifex/any_sender_of.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/just.hpp>
+#include <unifex/new_thread_context.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform.hpp>
+#include <unifex/with_allocator.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(int& count) noexcept : count_(&count) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : count_(other.count_) {}
+
+  T* allocate(std::size_t n) {
+    ++*count_;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool
+  operator==(const counting_allocator& a, const counting_allocator& b) noexcept {
+    return a.count_ == b.count_;
+  }
+
+  friend bool
+  operator!=(const counting_allocator& a, const counting_allocator& b) noexcept {
+    return a.count_ != b.count_;
+  }
+
+  int* count_;
+};
+
+// Completes inline with the address of its over-aligned operation-state.
+struct over_aligned_sender {
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<std::uintptr_t>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  template <typename Receiver>
+  struct operation {
+    void start() noexcept {
+      unifex::set_value(
+          std::move(receiver_), reinterpret_cast<std::uintptr_t>(this));
+    }
+
+    Receiver receiver_;
+    alignas(128) char data_[1];
+  };
+
+  template <typename Receiver>
+  operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+    return {(Receiver &&) r, {}};
+  }
+};
+} // namespace
+
+TEST(AnySenderOf, Values) {
+  any_sender_of<int> sender = transform(just(), [] { return 42; });
+  EXPECT_EQ(sync_wait(std::move(sender)).value(), 42);
+
+  // Values are converted to the declared types.
+  any_sender_of<std::string> converted = just("hello");
+  EXPECT_EQ(sync_wait(std::move(converted)).value(), "hello");
+}
+
+TEST(AnySenderOf, Error) {
+  any_sender_of<int> sender = transform(just(), []() -> int {
+    throw std::runtime_error{"error"};
+  });
+  EXPECT_THROW(sync_wait(std::move(sender)), std::runtime_error);
+}
+
+TEST(AnySenderOf, ForwardsStopRequests) {
+  timed_single_thread_context context;
+  any_sender_of<> sender = schedule_after(context.get_scheduler(), 10s);
+
+  inplace_stop_source stopSource;
+  stopSource.request_stop();
+  EXPECT_FALSE(sync_wait(std::move(sender), stopSource.get_token()));
+}
+
+TEST(AnySenderOf, AllocatesOperationStateWithReceiverAllocator) {
+  single_thread_context thread;
+
+  int count = 0;
+  any_sender_of<> sender = schedule(thread.get_scheduler());
+  sync_wait(with_allocator(
+      std::move(sender), counting_allocator<std::byte>{count}));
+  EXPECT_EQ(count, 1);
+
+  // Small enough operation-states are stored inline.
+  count = 0;
+  small_any_sender_of<64> smallSender = schedule(thread.get_scheduler());
+  sync_wait(with_allocator(
+      std::move(smallSender), counting_allocator<std::byte>{count}));
+  EXPECT_EQ(count, 0);
+}
+
+TEST(AnySenderOf, OverAlignedOperationState) {
+  any_sender_of<std::uintptr_t> sender = over_aligned_sender{};
+  std::uintptr_t address = sync_wait(std::move(sender)).value();
+  EXPECT_EQ(address % 128, 0u);
+}
+
+TEST(SharedAnySenderOf, Copies) {
+  shared_any_sender_of<int> sender = transform(just(), [] { return 42; });
+  shared_any_sender_of<int> copy = sender;
+
+  // Each copy, and each connect() of the same copy, runs the sender.
+  EXPECT_EQ(sync_wait(sender).value(), 42);
+  EXPECT_EQ(sync_wait(sender).value(), 42);
+  EXPECT_EQ(sync_wait(std::move(copy)).value(), 42);
+}
+
+TEST(AnyScheduler, Smoke) {
+  static_thread_pool pool{2};
+  single_thread_context thread;
+
+  any_scheduler s1 = pool.get_scheduler();
+  any_scheduler s2 = s1;
+  any_scheduler s3 = thread.get_scheduler();
+  EXPECT_TRUE(s1 == s2);
+  EXPECT_TRUE(s1 != s3);
+
+  s2 = s3;
+  EXPECT_TRUE(s2 == s3);
+
+  int value = 0;
+  sync_wait(transform(schedule(s1), [&] { value = 1; }));
+  EXPECT_EQ(value, 1);
+
+  static_assert(std::is_nothrow_move_constructible_v<any_scheduler>);
+  any_scheduler s4 = std::move(s1);
+  EXPECT_TRUE(s4 == any_scheduler{pool.get_scheduler()});
+  s1 = std::move(s4);
+  EXPECT_TRUE(s1 == any_scheduler{pool.get_scheduler()});
+}
+
+TEST(AnyScheduler, CopiesOfSchedulersWithoutEqualityCompareEqual) {
+  // new_thread_context's scheduler has state but no operator==.
+  new_thread_context context;
+  any_scheduler s1 = context.get_scheduler();
+  any_scheduler s2 = s1;
+  EXPECT_TRUE(s1 == s2);
+
+  static_thread_pool pool;
+  EXPECT_TRUE(s1 != any_scheduler{pool.get_scheduler()});
+}
@@ -20,6 +20,7 @@
 #include <cassert>
 #include <string>
 #include <typeindex>
+#include <array>
 #include <atomic>
 
 #include <gtest/gtest.h>
@@ -124,3 +125,37 @@ TEST(AnyUniqueTest, WithCustomAllocator) {
   EXPECT_EQ(res.total_allocated_bytes(), 0);
 }
 #endif
+
+using SmallA = unifex::small_any_unique_t<4 * sizeof(void*), get_typeid>;
+
+#if !UNIFEX_NO_MEMORY_RESOURCE
+TEST(AnyUniqueTest, SmallObjectsStoredInline) {
+  counting_memory_resource res{new_delete_resource()};
+  polymorphic_allocator<char> alloc{&res};
+  {
+    SmallA a1{std::allocator_arg, alloc, std::in_place_type<int>, 42};
+    EXPECT_EQ(get_typeid(a1), typeid(int));
+    EXPECT_EQ(res.total_allocated_bytes(), 0);
+
+    // Too large to fit inline so it is allocated from the allocator.
+    SmallA a2{std::allocator_arg, alloc, std::in_place_type<std::array<char, 256>>};
+    EXPECT_GE(res.total_allocated_bytes(), 256);
+
+    SmallA a3 = std::move(a1);
+    EXPECT_EQ(get_typeid(a3), typeid(int));
+    SmallA a4 = std::move(a2);
+    EXPECT_EQ(get_typeid(a4), typeid(std::array<char, 256>));
+  }
+  EXPECT_EQ(res.total_allocated_bytes(), 0);
+}
+#endif
+
+TEST(AnyUniqueTest, SmallObjectDestructor) {
+  bool hasDestructorRun = false;
+  {
+    SmallA a{std::in_place_type<destructor>, hasDestructorRun};
+    EXPECT_EQ(get_typeid(a), typeid(destructor));
+    EXPECT_FALSE(hasDestructorRun);
+  }
+  EXPECT_TRUE(hasDestructorRun);
+}
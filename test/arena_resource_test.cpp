@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/arena_resource.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(ArenaResource, ChunkIsRecycledOnceDrained) {
+  arena_resource arena{1024};
+
+  void* first = arena.allocate(100);
+  std::vector<void*> blocks{first};
+  // Fill up the first chunk so that the arena moves on to a second chunk.
+  while (blocks.size() < 20) {
+    blocks.push_back(arena.allocate(100));
+  }
+  for (void* p : blocks) {
+    arena_resource::deallocate(p);
+  }
+
+  // Moving past the second chunk makes the drained first chunk current
+  // again, starting from its beginning.
+  std::vector<void*> more;
+  bool reusedFirst = false;
+  for (int i = 0; i < 20 && !reusedFirst; ++i) {
+    more.push_back(arena.allocate(100));
+    reusedFirst = more.back() == first;
+  }
+  EXPECT_TRUE(reusedFirst);
+  for (void* p : more) {
+    arena_resource::deallocate(p);
+  }
+}
+
+TEST(ArenaResource, AlignmentAndLargeAllocations) {
+  arena_resource arena{256};
+
+  void* aligned = arena.allocate(16, 64);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 64, 0u);
+
+  void* large = arena.allocate(4096);
+  static_cast<char*>(large)[4095] = 'x';
+
+  arena_resource::deallocate(large);
+  arena_resource::deallocate(aligned);
+}
+
+TEST(ArenaResource, DeallocateFromOtherThread) {
+  arena_resource arena{4096};
+  arena_allocator<int> alloc{arena};
+
+  std::vector<int*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(alloc.allocate(8));
+  }
+
+  std::thread t{[&] {
+    for (int* p : blocks) {
+      alloc.deallocate(p, 8);
+    }
+  }};
+  t.join();
+
+  int* p = alloc.allocate(8);
+  alloc.deallocate(p, 8);
+}
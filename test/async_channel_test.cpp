@@ -0,0 +1,136 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_channel.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(AsyncChannel, ProducerConsumer) {
+  async_channel<int> channel{4};
+
+  std::thread producer{[&] {
+    for (int i = 1; i <= 10'000; ++i) {
+      sync_wait(channel.send(i));
+    }
+    channel.close();
+  }};
+
+  auto sum = sync_wait(reduce_stream(
+      channel.stream(), 0L, [](long state, int value) {
+        return state + value;
+      }));
+  producer.join();
+
+  EXPECT_EQ(sum.value(), 10'000L * 10'001 / 2);
+}
+
+TEST(AsyncChannel, ValuesSentBeforeCloseAreReceived) {
+  async_channel<int> channel{2};
+  sync_wait(channel.send(1));
+  sync_wait(channel.send(2));
+  channel.close();
+
+  // Sending to a closed channel completes with done.
+  EXPECT_FALSE(sync_wait(channel.send(3)).has_value());
+
+  auto count = sync_wait(reduce_stream(
+      channel.stream(), 0, [](int state, int) { return state + 1; }));
+  EXPECT_EQ(count.value(), 2);
+}
+
+TEST(AsyncChannel, Cancellation) {
+  async_channel<int> channel{2};
+
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stopSource.request_stop();
+  }};
+
+  // A waiting next() completes with done once stop is requested.
+  auto count = sync_wait(
+      reduce_stream(
+          channel.stream(), 0, [](int state, int) { return state + 1; }),
+      stopSource.get_token());
+  t.join();
+
+  EXPECT_EQ(count.value(), 0);
+}
+
+TEST(AsyncChannel, StressOwningValues) {
+  // A single-slot buffer makes both sides park and wake each other as often
+  // as possible. Values that own memory expose any value that is moved or
+  // destroyed twice.
+  constexpr int count = 100'000;
+  async_channel<std::unique_ptr<int>> channel{1};
+
+  std::thread producer{[&] {
+    for (int i = 0; i < count; ++i) {
+      sync_wait(channel.send(std::make_unique<int>(i)));
+    }
+    channel.close();
+  }};
+
+  auto received = sync_wait(reduce_stream(
+      channel.stream(), 0, [](int expected, std::unique_ptr<int> value) {
+        EXPECT_NE(value, nullptr);
+        EXPECT_EQ(*value, expected);
+        return expected + 1;
+      }));
+  producer.join();
+
+  EXPECT_EQ(received.value(), count);
+}
+
+TEST(AsyncChannel, StressCancellation) {
+  // Races stop requests against the other side making progress.
+  for (int round = 0; round < 1'000; ++round) {
+    async_channel<std::unique_ptr<int>> channel{1};
+    inplace_stop_source stopSource;
+
+    std::thread producer{[&] {
+      for (int i = 0; i < 10; ++i) {
+        if (!sync_wait(
+                 channel.send(std::make_unique<int>(i)),
+                 stopSource.get_token())) {
+          break;
+        }
+      }
+    }};
+    std::thread stopper{[&] { stopSource.request_stop(); }};
+
+    auto received = sync_wait(
+        reduce_stream(
+            channel.stream(),
+            0,
+            [](int expected, std::unique_ptr<int> value) {
+              EXPECT_EQ(*value, expected);
+              return expected + 1;
+            }),
+        stopSource.get_token());
+    stopper.join();
+    producer.join();
+
+    EXPECT_LE(received.value(), 10);
+  }
+}
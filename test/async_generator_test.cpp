@@ -0,0 +1,244 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#include <unifex/async_generator.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+// Counts copies so that we can check values are yielded by reference.
+struct counted {
+  explicit counted(int value) noexcept : value_(value) {}
+  counted(const counted& other) noexcept : value_(other.value_) {
+    ++copies;
+  }
+
+  int value_;
+  static inline int copies = 0;
+};
+
+// Sets a flag when the generator's body is destroyed.
+struct destroy_guard {
+  ~destroy_guard() {
+    destroyed_ = true;
+  }
+
+  bool& destroyed_;
+};
+
+// Completes with set_done().
+struct done_sender {
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  template <typename Receiver>
+  struct operation {
+    Receiver receiver_;
+
+    void start() noexcept {
+      unifex::set_done(std::move(receiver_));
+    }
+  };
+
+  template <typename Receiver>
+  operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+    return {(Receiver &&) r};
+  }
+};
+
+// Completes with whether stop is possible on the receiver's stop-token.
+struct stop_possible_sender {
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<bool>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  template <typename Receiver>
+  struct operation {
+    Receiver receiver_;
+
+    void start() noexcept {
+      const bool stopPossible = get_stop_token(receiver_).stop_possible();
+      unifex::set_value(std::move(receiver_), stopPossible);
+    }
+  };
+
+  template <typename Receiver>
+  operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+    return {(Receiver &&) r};
+  }
+};
+
+async_generator<counted> count_to(int n) {
+  for (int i = 1; i <= n; ++i) {
+    counted value{i};
+    co_yield value;
+  }
+}
+
+async_generator<int> yield_then_done(bool& destroyed) {
+  destroy_guard guard{destroyed};
+  co_yield 1;
+  co_await done_sender{};
+  co_yield 2;
+}
+
+async_generator<int> yield_then_throw() {
+  co_yield 1;
+  throw std::runtime_error("generator failed");
+}
+
+async_generator<bool> stop_possible() {
+  co_yield co_await stop_possible_sender{};
+}
+
+async_generator<int> wait_forever(
+    timed_single_thread_context& context, bool& destroyed) {
+  destroy_guard guard{destroyed};
+  co_yield 1;
+  co_await schedule_after(context.get_scheduler(), 1h);
+  co_yield 2;
+}
+
+async_generator<int> count_forever(bool& destroyed) {
+  destroy_guard guard{destroyed};
+  for (int i = 0;; ++i) {
+    co_yield i;
+  }
+}
+
+auto collect_ints() {
+  return [](std::vector<int> state, int value) {
+    state.push_back(value);
+    return state;
+  };
+}
+} // namespace
+
+TEST(AsyncGenerator, YieldsValuesByReference) {
+  counted::copies = 0;
+  auto sum = sync_wait(reduce_stream(
+      count_to(10), 0, [](int state, const counted& value) {
+        return state + value.value_;
+      }));
+
+  EXPECT_EQ(sum.value(), 55);
+  EXPECT_EQ(counted::copies, 0);
+}
+
+TEST(AsyncGenerator, AwaitedDoneEndsTheStream) {
+  bool destroyed = false;
+  auto values = sync_wait(reduce_stream(
+      yield_then_done(destroyed), std::vector<int>{}, collect_ints()));
+
+  EXPECT_EQ(values.value(), std::vector<int>{1});
+  EXPECT_TRUE(destroyed);
+}
+
+TEST(AsyncGenerator, ExceptionsPropagate) {
+  EXPECT_THROW(
+      sync_wait(reduce_stream(
+          yield_then_throw(), std::vector<int>{}, collect_ints())),
+      std::runtime_error);
+}
+
+TEST(AsyncGenerator, AwaitedSendersReceiveTheStopToken) {
+  auto unstoppable = sync_wait(reduce_stream(
+      stop_possible(), std::vector<bool>{}, [](auto state, bool value) {
+        state.push_back(value);
+        return state;
+      }));
+  EXPECT_EQ(unstoppable.value(), std::vector<bool>{false});
+
+  inplace_stop_source stopSource;
+  auto stoppable = sync_wait(
+      reduce_stream(
+          stop_possible(),
+          std::vector<bool>{},
+          [](auto state, bool value) {
+            state.push_back(value);
+            return state;
+          }),
+      stopSource.get_token());
+  EXPECT_EQ(stoppable.value(), std::vector<bool>{true});
+}
+
+TEST(AsyncGenerator, StopRequestCancelsAwaitedSender) {
+  timed_single_thread_context context;
+  inplace_stop_source stopSource;
+  bool destroyed = false;
+
+  std::thread stopper{[&] {
+    std::this_thread::sleep_for(10ms);
+    stopSource.request_stop();
+  }};
+
+  auto values = sync_wait(
+      reduce_stream(
+          wait_forever(context, destroyed),
+          std::vector<int>{},
+          collect_ints()),
+      stopSource.get_token());
+  stopper.join();
+
+  EXPECT_EQ(values.value(), std::vector<int>{1});
+  EXPECT_TRUE(destroyed);
+}
+
+TEST(AsyncGenerator, CleanupDestroysSuspendedBody) {
+  bool destroyed = false;
+  EXPECT_THROW(
+      sync_wait(reduce_stream(
+          count_forever(destroyed),
+          0,
+          [](int, int value) {
+            if (value == 3) {
+              throw std::runtime_error("consumer failed");
+            }
+            return value;
+          })),
+      std::runtime_error);
+
+  EXPECT_TRUE(destroyed);
+}
+
+#endif  // UNIFEX_NO_COROUTINES
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_barrier.hpp>
+#include <unifex/async_latch.hpp>
+#include <unifex/async_manual_reset_event.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/submit.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+
+struct counting_receiver {
+  std::atomic<int>& count_;
+
+  void set_value() && noexcept { ++count_; }
+  void set_done() && noexcept { std::terminate(); }
+  void set_error(std::exception_ptr) && noexcept { std::terminate(); }
+};
+
+} // namespace
+
+TEST(async_manual_reset_event, set_releases_all_waiters) {
+  async_manual_reset_event event;
+  std::atomic<int> count{0};
+  auto op1 = connect(event.async_wait(), counting_receiver{count});
+  auto op2 = connect(event.async_wait(), counting_receiver{count});
+  start(op1);
+  start(op2);
+  EXPECT_EQ(count.load(), 0);
+  EXPECT_FALSE(event.ready());
+
+  event.set();
+  EXPECT_EQ(count.load(), 2);
+  EXPECT_TRUE(event.ready());
+
+  // Completes inline while the event is set.
+  auto op3 = connect(event.async_wait(), counting_receiver{count});
+  start(op3);
+  EXPECT_EQ(count.load(), 3);
+
+  event.reset();
+  EXPECT_FALSE(event.ready());
+  auto op4 = connect(event.async_wait(), counting_receiver{count});
+  start(op4);
+  EXPECT_EQ(count.load(), 3);
+  event.set();
+  EXPECT_EQ(count.load(), 4);
+}
+
+TEST(async_manual_reset_event, wait_on_resumes_on_scheduler) {
+  async_manual_reset_event event;
+  single_thread_context ctx;
+
+  std::thread::id ctxThread;
+  sync_wait(transform(schedule(ctx.get_scheduler()), [&] {
+    ctxThread = std::this_thread::get_id();
+  }));
+
+  std::thread::id resumedOn;
+  std::atomic<int> count{0};
+  auto op = connect(
+      transform(
+          event.async_wait_on(ctx.get_scheduler()),
+          [&] { resumedOn = std::this_thread::get_id(); }),
+      counting_receiver{count});
+  start(op);
+  event.set();
+  while (count.load() == 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(resumedOn, ctxThread);
+}
+
+TEST(async_latch, waits_for_all_count_downs) {
+  constexpr int shards = 8;
+  async_latch latch{shards};
+  std::atomic<int> loaded{0};
+  std::atomic<int> submitted{0};
+  static_thread_pool pool;
+
+  for (int i = 0; i < shards; ++i) {
+    submit(
+        transform(schedule(pool.get_scheduler()), [&] {
+          ++loaded;
+          latch.count_down();
+        }),
+        counting_receiver{submitted});
+  }
+
+  sync_wait(latch.async_wait());
+  EXPECT_TRUE(latch.try_wait());
+  EXPECT_EQ(loaded.load(), shards);
+}
+
+TEST(async_barrier, phases_complete_together) {
+  constexpr int participants = 4;
+  constexpr int phases = 1'000;
+  async_barrier barrier{participants};
+  std::atomic<int> arrivals{0};
+  std::atomic<bool> failed{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < participants; ++t) {
+    threads.emplace_back([&] {
+      for (int phase = 1; phase <= phases; ++phase) {
+        ++arrivals;
+        sync_wait(barrier.async_arrive_and_wait());
+        // Everyone has arrived for this phase and nobody can have
+        // arrived for the phase after the next one.
+        int n = arrivals.load();
+        if (n < phase * participants || n > (phase + 1) * participants) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_FALSE(failed.load());
+  EXPECT_EQ(arrivals.load(), participants * phases);
+}
@@ -14,23 +14,130 @@
  * limitations under the License.
  */
 
+#include <unifex/async_mutex.hpp>
 #include <unifex/coroutine.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_event_loop.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform.hpp>
 
-#if !UNIFEX_NO_COROUTINES
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
 
-#  include <unifex/async_mutex.hpp>
+#if !UNIFEX_NO_COROUTINES
 #  include <unifex/awaitable_sender.hpp>
-#  include <unifex/scheduler_concepts.hpp>
 #  include <unifex/sender_awaitable.hpp>
-#  include <unifex/single_thread_context.hpp>
-#  include <unifex/sync_wait.hpp>
 #  include <unifex/task.hpp>
 #  include <unifex/when_all.hpp>
-
-#  include <gtest/gtest.h>
+#endif
 
 using namespace unifex;
 
+namespace {
+
+struct lock_receiver {
+  std::atomic<int>& state_;
+  inplace_stop_token stopToken_;
+
+  // 1 = acquired, 2 = cancelled
+  void set_value() && noexcept { state_ = 1; }
+  void set_done() && noexcept { state_ = 2; }
+  void set_error(std::exception_ptr) && noexcept { std::terminate(); }
+
+  friend inplace_stop_token tag_invoke(
+      tag_t<get_stop_token>, const lock_receiver& r) noexcept {
+    return r.stopToken_;
+  }
+};
+
+} // namespace
+
+TEST(async_mutex, stop_request_removes_waiter) {
+  async_mutex mutex;
+  ASSERT_TRUE(mutex.try_lock());
+
+  inplace_stop_source stopSource;
+  std::atomic<int> first{0};
+  std::atomic<int> second{0};
+  auto op1 = connect(
+      mutex.async_lock(), lock_receiver{first, stopSource.get_token()});
+  auto op2 = connect(mutex.async_lock(), lock_receiver{second, {}});
+  start(op1);
+  start(op2);
+
+  // The first waiter completes without waiting for unlock().
+  stopSource.request_stop();
+  EXPECT_EQ(first.load(), 2);
+  EXPECT_EQ(second.load(), 0);
+
+  mutex.unlock();
+  EXPECT_EQ(second.load(), 1);
+  mutex.unlock();
+}
+
+TEST(async_mutex, lock_on_resumes_on_scheduler) {
+  async_mutex mutex;
+  single_thread_context ctx;
+  ASSERT_TRUE(mutex.try_lock());
+
+  std::thread::id ctxThread;
+  sync_wait(transform(schedule(ctx.get_scheduler()), [&] {
+    ctxThread = std::this_thread::get_id();
+  }));
+
+  std::thread::id resumedOn;
+  std::atomic<int> state{0};
+  auto op = connect(
+      transform(
+          mutex.async_lock_on(ctx.get_scheduler()),
+          [&] { resumedOn = std::this_thread::get_id(); }),
+      lock_receiver{state, {}});
+  start(op);
+  EXPECT_EQ(state.load(), 0);
+
+  mutex.unlock();
+  while (state.load() == 0) {
+    std::this_thread::yield();
+  }
+
+  EXPECT_EQ(resumedOn, ctxThread);
+  mutex.unlock();
+}
+
+TEST(async_mutex, unlock_hands_lock_to_waiter) {
+  async_mutex mutex;
+  manual_event_loop loop;
+  ASSERT_TRUE(mutex.try_lock());
+
+  std::atomic<int> state{0};
+  auto op = connect(
+      mutex.async_lock_on(loop.get_scheduler()), lock_receiver{state, {}});
+  start(op);
+
+  // The waiter owns the lock from the moment it is released, even though
+  // it has not been resumed yet.
+  mutex.unlock();
+  EXPECT_FALSE(mutex.try_lock());
+  EXPECT_EQ(state.load(), 0);
+
+  std::thread thread{[&] { loop.run(); }};
+  while (state.load() == 0) {
+    std::this_thread::yield();
+  }
+  loop.stop();
+  thread.join();
+
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+#if !UNIFEX_NO_COROUTINES
 TEST(async_mutex, multiple_threads) {
   async_mutex mutex;
 
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/async_semaphore.hpp>
+#include <unifex/async_shared_mutex.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+
+struct result {
+  bool value = false;
+  bool done = false;
+};
+
+struct recording_receiver {
+  result& result_;
+  inplace_stop_token stopToken_;
+
+  void set_value() && noexcept { result_.value = true; }
+  void set_done() && noexcept { result_.done = true; }
+  void set_error(std::exception_ptr) && noexcept { std::terminate(); }
+
+  friend inplace_stop_token tag_invoke(
+      tag_t<get_stop_token>, const recording_receiver& r) noexcept {
+    return r.stopToken_;
+  }
+};
+
+} // namespace
+
+TEST(async_semaphore, try_acquire_and_release) {
+  async_semaphore semaphore{2};
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_FALSE(semaphore.try_acquire(2));
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_FALSE(semaphore.try_acquire());
+  semaphore.release(2);
+  EXPECT_TRUE(semaphore.try_acquire(2));
+  semaphore.release(2);
+}
+
+TEST(async_semaphore, waiter_completes_on_release) {
+  async_semaphore semaphore{0};
+  result r;
+  auto op = connect(semaphore.async_acquire(2), recording_receiver{r, {}});
+  start(op);
+  EXPECT_FALSE(r.value);
+
+  semaphore.release();
+  EXPECT_FALSE(r.value);
+  // The released permit is reserved for the waiter.
+  EXPECT_FALSE(semaphore.try_acquire());
+
+  semaphore.release();
+  EXPECT_TRUE(r.value);
+  EXPECT_FALSE(semaphore.try_acquire());
+}
+
+TEST(async_semaphore, stop_request_cancels_waiter) {
+  async_semaphore semaphore{1};
+  inplace_stop_source stopSource;
+  result r;
+  auto op = connect(
+      semaphore.async_acquire(2),
+      recording_receiver{r, stopSource.get_token()});
+  start(op);
+
+  semaphore.release(0);
+  EXPECT_FALSE(r.value);
+  EXPECT_FALSE(r.done);
+
+  stopSource.request_stop();
+  EXPECT_TRUE(r.done);
+  EXPECT_FALSE(r.value);
+  // The permit that had been reserved for the waiter is available again.
+  EXPECT_TRUE(semaphore.try_acquire());
+  semaphore.release();
+}
+
+TEST(async_semaphore, multiple_threads) {
+  constexpr std::ptrdiff_t permits = 3;
+  async_semaphore semaphore{permits};
+  std::atomic<int> holders{0};
+  std::atomic<int> maxHolders{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 6; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10'000; ++i) {
+        sync_wait(semaphore.async_acquire());
+        int current = holders.fetch_add(1) + 1;
+        int max = maxHolders.load();
+        while (current > max && !maxHolders.compare_exchange_weak(max, current)) {
+        }
+        holders.fetch_sub(1);
+        semaphore.release();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_LE(maxHolders.load(), permits);
+  EXPECT_TRUE(semaphore.try_acquire(permits));
+  semaphore.release(permits);
+}
+
+TEST(async_shared_mutex, readers_share_writers_exclude) {
+  async_shared_mutex mutex;
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_TRUE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+
+  result writer;
+  auto op = connect(mutex.async_lock(), recording_receiver{writer, {}});
+  start(op);
+  EXPECT_FALSE(writer.value);
+  // A waiting writer holds back new readers.
+  EXPECT_FALSE(mutex.try_lock_shared());
+
+  mutex.unlock_shared();
+  EXPECT_FALSE(writer.value);
+  mutex.unlock_shared();
+  EXPECT_TRUE(writer.value);
+
+  result reader;
+  auto readOp =
+      connect(mutex.async_lock_shared(), recording_receiver{reader, {}});
+  start(readOp);
+  EXPECT_FALSE(reader.value);
+  mutex.unlock();
+  EXPECT_TRUE(reader.value);
+  mutex.unlock_shared();
+
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
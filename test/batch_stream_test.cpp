@@ -0,0 +1,77 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/batch_stream.hpp>
+#include <unifex/delay.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+namespace {
+auto batch_sizes = [](std::vector<std::size_t> sizes, span<int> batch) {
+  sizes.push_back(batch.size());
+  return sizes;
+};
+} // namespace
+
+TEST(BatchStream, CountBound) {
+  timed_single_thread_context context;
+
+  auto sizes = sync_wait(reduce_stream(
+      batch_stream(range_stream{0, 10}, 4, 1h, context.get_scheduler()),
+      std::vector<std::size_t>{},
+      batch_sizes));
+
+  EXPECT_EQ(*sizes, (std::vector<std::size_t>{4, 4, 2}));
+}
+
+TEST(BatchStream, PreservesOrder) {
+  timed_single_thread_context context;
+
+  auto values = sync_wait(reduce_stream(
+      batch_stream(range_stream{0, 100}, 7, 1h, context.get_scheduler()),
+      std::vector<int>{},
+      [](std::vector<int> state, span<int> batch) {
+        state.insert(state.end(), batch.begin(), batch.end());
+        return state;
+      }));
+
+  ASSERT_EQ(values->size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ((*values)[i], i);
+  }
+}
+
+TEST(BatchStream, TimeBound) {
+  timed_single_thread_context context;
+  auto scheduler = context.get_scheduler();
+
+  // Each value arrives long after the previous batch's timer has fired.
+  auto sizes = sync_wait(reduce_stream(
+      batch_stream(delay(range_stream{0, 3}, scheduler, 50ms), 100, 5ms, scheduler),
+      std::vector<std::size_t>{},
+      batch_sizes));
+
+  EXPECT_EQ(*sizes, (std::vector<std::size_t>{1, 1, 1}));
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/indexed_for.hpp>
+#include <unifex/just.hpp>
+#include <unifex/manual_event_loop.hpp>
+#include <unifex/on.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace execution {
+class sequenced_policy {};
+class parallel_policy {};
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+} // namespace execution
+
+namespace {
+struct index_range {
+  struct iterator {
+    using value_type = std::size_t;
+    using reference = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using iterator_category = std::random_access_iterator_tag;
+
+    std::size_t operator[](std::size_t offset) const {
+      return base_ + offset;
+    }
+
+    std::size_t base_;
+  };
+
+  iterator begin() const {
+    return iterator{0};
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  std::size_t size_;
+};
+} // namespace
+
+TEST(IndexedFor, ParallelOnExplicitScheduler) {
+  static_thread_pool pool{4};
+
+  auto result = sync_wait(indexed_for(
+      just(std::vector<int>(10000, 1)),
+      execution::par,
+      index_range{10000},
+      [](std::size_t idx, std::vector<int>& v) { v[idx] += static_cast<int>(idx); },
+      pool.get_scheduler()));
+
+  ASSERT_TRUE(result);
+  for (std::size_t i = 0; i < result->size(); ++i) {
+    EXPECT_EQ((*result)[i], static_cast<int>(i) + 1);
+  }
+}
+
+TEST(IndexedFor, ParallelOnReceiverScheduler) {
+  static_thread_pool pool{4};
+
+  std::vector<int> v(1000, 0);
+  sync_wait(on(
+      indexed_for(
+          just(),
+          execution::par,
+          index_range{v.size()},
+          [&](std::size_t idx) { v[idx] = 1; }),
+      pool.get_scheduler()));
+
+  for (int x : v) {
+    EXPECT_EQ(x, 1);
+  }
+}
+
+TEST(IndexedFor, ParallelError) {
+  static_thread_pool pool{4};
+
+  EXPECT_THROW(
+      sync_wait(indexed_for(
+          just(),
+          execution::par,
+          index_range{1000},
+          [](std::size_t idx) {
+            if (idx == 500) {
+              throw std::runtime_error{"error"};
+            }
+          },
+          pool.get_scheduler())),
+      std::runtime_error);
+}
+
+TEST(IndexedFor, ParallelBlocking) {
+  static_thread_pool pool{2};
+  manual_event_loop loop;
+  auto noop = [](std::size_t) {};
+
+  // May complete on one of the pool's threads.
+  EXPECT_EQ(
+      blocking(indexed_for(
+          just(), execution::par, index_range{10}, noop, pool.get_scheduler())),
+      blocking_kind::maybe);
+
+  // Never completes inline if the predecessor never does.
+  EXPECT_EQ(
+      blocking(indexed_for(
+          schedule(loop.get_scheduler()),
+          execution::par,
+          index_range{10},
+          noop)),
+      blocking_kind::never);
+}
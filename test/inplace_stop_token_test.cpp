@@ -0,0 +1,143 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/inplace_stop_token.hpp>
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(InplaceStopToken, RequestStopRunsEveryCallback) {
+  inplace_stop_source source;
+  int count = 0;
+  {
+    // More callbacks than there are slots, so some go on the list.
+    std::vector<std::optional<inplace_stop_callback<std::function<void()>>>>
+        callbacks(20);
+    for (auto& cb : callbacks) {
+      cb.emplace(source.get_token(), [&] { ++count; });
+    }
+    callbacks[3].reset();
+    callbacks[15].reset();
+
+    EXPECT_FALSE(source.request_stop());
+    EXPECT_EQ(count, 18);
+    EXPECT_TRUE(source.request_stop());
+  }
+
+  inplace_stop_callback cb{source.get_token(), [&] { ++count; }};
+  EXPECT_EQ(count, 19);
+}
+
+TEST(InplaceStopToken, CallbackCanDeregisterItself) {
+  inplace_stop_source source;
+  std::optional<inplace_stop_callback<std::function<void()>>> cb;
+  cb.emplace(source.get_token(), [&] { cb.reset(); });
+  source.request_stop();
+  EXPECT_FALSE(cb.has_value());
+}
+
+TEST(InplaceStopToken, ConcurrentRegistrationAndStop) {
+  using callback_t = inplace_stop_callback<std::function<void()>>;
+
+  for (int run = 0; run < 100; ++run) {
+    inplace_stop_source source;
+    std::atomic<bool> go{false};
+    std::atomic<bool> stopped{false};
+    std::vector<std::vector<int>> calls(4);
+    std::vector<std::thread> threads;
+    for (auto& threadCalls : calls) {
+      threads.emplace_back([&] {
+        // Callbacks stay registered until request_stop() has returned, so
+        // each one must run exactly once, either from there or inline.
+        std::vector<std::optional<callback_t>> callbacks(64);
+        threadCalls.resize(callbacks.size());
+        while (!go.load()) {
+          std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < callbacks.size(); ++i) {
+          callbacks[i].emplace(
+              source.get_token(), [&threadCalls, i] { ++threadCalls[i]; });
+        }
+        while (!stopped.load()) {
+          std::this_thread::yield();
+        }
+      });
+    }
+    go = true;
+    std::this_thread::yield();
+    source.request_stop();
+    stopped = true;
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (auto& threadCalls : calls) {
+      for (int count : threadCalls) {
+        EXPECT_EQ(count, 1);
+      }
+    }
+  }
+}
+
+TEST(InplaceStopChildSource, PollsParentWithoutRegistering) {
+  inplace_stop_source parent;
+  inplace_stop_child_source child{parent.get_token()};
+  inplace_stop_child_source grandchild{child.get_token()};
+
+  EXPECT_FALSE(grandchild.stop_requested());
+  parent.request_stop();
+  EXPECT_TRUE(child.stop_requested());
+  EXPECT_TRUE(grandchild.get_token().stop_requested());
+}
+
+TEST(InplaceStopChildSource, ForwardsStopToCallbacks) {
+  inplace_stop_source parent;
+  inplace_stop_child_source child{parent.get_token()};
+  inplace_stop_child_source grandchild{child.get_token()};
+
+  int count = 0;
+  {
+    inplace_stop_callback cb{grandchild.get_token(), [&] { ++count; }};
+    parent.request_stop();
+    EXPECT_EQ(count, 1);
+  }
+
+  // Registering after the parent was stopped runs inline.
+  inplace_stop_child_source late{parent.get_token()};
+  inplace_stop_callback cb{late.get_token(), [&] { ++count; }};
+  EXPECT_EQ(count, 2);
+}
+
+TEST(InplaceStopChildSource, StopDoesNotPropagateUpwards) {
+  inplace_stop_source parent;
+  inplace_stop_child_source child{parent.get_token()};
+
+  int count = 0;
+  inplace_stop_callback cb{child.get_token(), [&] { ++count; }};
+  child.request_stop();
+  EXPECT_EQ(count, 1);
+  EXPECT_FALSE(parent.stop_requested());
+
+  child.unlink();
+  parent.request_stop();
+  EXPECT_EQ(count, 1);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/parallel_reduce.hpp>
+#include <unifex/span.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(ParallelReduce, ContiguousSum) {
+  static_thread_pool pool{4};
+
+  std::vector<double> values(100003);
+  std::iota(values.begin(), values.end(), 0.0);
+
+  auto sum = sync_wait(parallel_reduce(
+      span<double>{values.data(), values.size()},
+      pool.get_scheduler(),
+      1.0,
+      std::plus<>{}));
+
+  EXPECT_DOUBLE_EQ(*sum, 1.0 + 100002.0 * 100003.0 / 2);
+}
+
+TEST(ParallelReduce, PreservesOrder) {
+  static_thread_pool pool{4};
+
+  std::vector<std::string> words;
+  std::string expected = ">";
+  for (int i = 0; i < 1000; ++i) {
+    words.push_back(std::to_string(i));
+    expected += words.back();
+  }
+
+  // String concatenation is associative but not commutative.
+  auto result = sync_wait(parallel_reduce(
+      std::move(words), pool.get_scheduler(), std::string{">"}, std::plus<>{}));
+
+  EXPECT_EQ(*result, expected);
+}
+
+TEST(ParallelReduce, Empty) {
+  static_thread_pool pool{4};
+
+  auto result = sync_wait(parallel_reduce(
+      std::vector<int>{}, pool.get_scheduler(), 42, std::plus<>{}));
+
+  EXPECT_EQ(*result, 42);
+}
+
+TEST(ParallelReduce, Error) {
+  static_thread_pool pool{4};
+
+  EXPECT_THROW(
+      sync_wait(parallel_reduce(
+          std::vector<int>(1000, 1),
+          pool.get_scheduler(),
+          0,
+          [](int a, int b) {
+            if (a > 100) {
+              throw std::runtime_error{"overflow"};
+            }
+            return a + b;
+          })),
+      std::runtime_error);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/just.hpp>
+#include <unifex/pool_allocator.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform.hpp>
+#include <unifex/via.hpp>
+#include <unifex/when_all.hpp>
+#include <unifex/with_allocator.hpp>
+
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(PoolAllocator, ReusesFreedBlocks) {
+  pool_allocator<std::uint64_t> alloc;
+  std::uint64_t* p1 = alloc.allocate(3);
+  alloc.deallocate(p1, 3);
+  std::uint64_t* p2 = alloc.allocate(3);
+  EXPECT_EQ(p1, p2);
+  alloc.deallocate(p2, 3);
+}
+
+TEST(PoolAllocator, LargeAndOverAlignedAllocations) {
+  struct alignas(64) over_aligned {
+    char data[64];
+  };
+  pool_allocator<over_aligned> alignedAlloc;
+  over_aligned* p = alignedAlloc.allocate(2);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 64, 0u);
+  alignedAlloc.deallocate(p, 2);
+
+  pool_allocator<char> charAlloc;
+  char* big = charAlloc.allocate(1 << 20);
+  big[(1 << 20) - 1] = 'x';
+  charAlloc.deallocate(big, 1 << 20);
+}
+
+TEST(PoolAllocator, CrossThreadFree) {
+  pool_allocator<char> alloc;
+  std::vector<char*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(alloc.allocate(100));
+    blocks.back()[0] = static_cast<char>(i);
+  }
+
+  std::thread t{[&] {
+    for (char* p : blocks) {
+      alloc.deallocate(p, 100);
+    }
+  }};
+  // The other thread hands back its last, partial batch when it exits, so
+  // every block has been returned to this thread's cache once join()
+  // returns.
+  t.join();
+
+  // Blocks returned by the other thread are reused by this one before any
+  // new memory is carved.
+  std::set<char*> freed{blocks.begin(), blocks.end()};
+  std::vector<char*> reused;
+  for (int i = 0; i < 1000; ++i) {
+    reused.push_back(alloc.allocate(100));
+    EXPECT_EQ(freed.erase(reused.back()), 1u);
+  }
+  EXPECT_TRUE(freed.empty());
+  for (char* p : reused) {
+    alloc.deallocate(p, 100);
+  }
+}
+
+TEST(PoolAllocator, WithAllocator) {
+  single_thread_context thread;
+  int value = 0;
+
+  auto addToValue = [&](int x) {
+    return transform(via(schedule(thread.get_scheduler()), just(x)), [&](int x) {
+      value += x;
+    });
+  };
+
+  sync_wait(with_allocator(
+      when_all(addToValue(1), addToValue(2)), pool_allocator<>{}));
+
+  EXPECT_EQ(value, 3);
+}
+
+#if !UNIFEX_NO_MEMORY_RESOURCE
+TEST(PoolAllocator, MemoryResource) {
+  pmr::memory_resource* res = pool_memory_resource();
+  EXPECT_TRUE(res->is_equal(*pool_memory_resource()));
+
+  pmr::polymorphic_allocator<int> alloc{res};
+  int* p = alloc.allocate(10);
+  p[9] = 42;
+  alloc.deallocate(p, 10);
+}
+#endif
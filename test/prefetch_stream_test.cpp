@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/prefetch_stream.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/via_stream.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(PrefetchStream, PreservesOrder) {
+  single_thread_context thread;
+
+  auto values = sync_wait(reduce_stream(
+      prefetch_stream(
+          via_stream(thread.get_scheduler(), range_stream{0, 100}), 4),
+      std::vector<int>{},
+      [](std::vector<int> state, int value) {
+        state.push_back(value);
+        return state;
+      }));
+
+  ASSERT_EQ(values->size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ((*values)[i], i);
+  }
+}
+
+TEST(PrefetchStream, InlineSource) {
+  auto sum = sync_wait(reduce_stream(
+      prefetch_stream(range_stream{0, 10}, 3), 0, [](int state, int value) {
+        return state + value;
+      }));
+  EXPECT_EQ(sum.value(), 45);
+}
+
+TEST(PrefetchStream, CleanupWaitsForInFlightNext) {
+  single_thread_context thread;
+
+  // The consumer stops early while values are still being prefetched.
+  EXPECT_THROW(
+      sync_wait(reduce_stream(
+          prefetch_stream(
+              via_stream(thread.get_scheduler(), range_stream{0, 1000}), 8),
+          0,
+          [](int state, int value) {
+            if (value == 3) {
+              throw std::runtime_error{"stop"};
+            }
+            return state + value;
+          })),
+      std::runtime_error);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/ready_done_sender.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+// A stream of lvalue references to the elements of a vector.
+template <typename T>
+struct element_stream {
+  struct next_sender {
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<T&>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<>;
+
+    template <typename Receiver>
+    struct operation {
+      element_stream& stream_;
+      Receiver receiver_;
+
+      void start() noexcept {
+        if (stream_.index_ == stream_.values_.size()) {
+          unifex::set_done(std::move(receiver_));
+        } else {
+          unifex::set_value(
+              std::move(receiver_), stream_.values_[stream_.index_++]);
+        }
+      }
+    };
+
+    template <typename Receiver>
+    operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+      return {stream_, (Receiver &&) r};
+    }
+
+    element_stream& stream_;
+  };
+
+  friend next_sender tag_invoke(tag_t<next>, element_stream& s) noexcept {
+    return next_sender{s};
+  }
+
+  friend ready_done_sender
+  tag_invoke(tag_t<cleanup>, element_stream&) noexcept {
+    return {};
+  }
+
+  std::vector<T>& values_;
+  std::size_t index_ = 0;
+};
+
+// A stream of lvalue references to a value owned by the next() operation,
+// which counts the next() operations that are alive.
+struct operation_owned_stream {
+  struct next_sender {
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<int&>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<>;
+
+    template <typename Receiver>
+    struct operation {
+      template <typename Receiver2>
+      operation(int value, int& liveCount, Receiver2&& r)
+        : value_(value), liveCount_(liveCount), receiver_((Receiver2 &&) r) {
+        ++liveCount_;
+      }
+
+      operation(operation&&) = delete;
+
+      ~operation() {
+        --liveCount_;
+      }
+
+      void start() noexcept {
+        if (value_ > 10) {
+          unifex::set_done(std::move(receiver_));
+        } else {
+          unifex::set_value(std::move(receiver_), value_);
+        }
+      }
+
+      int value_;
+      int& liveCount_;
+      Receiver receiver_;
+    };
+
+    template <typename Receiver>
+    operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+      return {value_, liveCount_, (Receiver &&) r};
+    }
+
+    int value_;
+    int& liveCount_;
+  };
+
+  friend next_sender
+  tag_invoke(tag_t<next>, operation_owned_stream& s) noexcept {
+    return next_sender{++s.count_, s.liveCount_};
+  }
+
+  friend ready_done_sender
+  tag_invoke(tag_t<cleanup>, operation_owned_stream&) noexcept {
+    return {};
+  }
+
+  int& liveCount_;
+  int count_ = 0;
+};
+} // namespace
+
+TEST(ReduceStream, ForwardsLvalueReferences) {
+  std::vector<std::unique_ptr<int>> values;
+  for (int i = 0; i < 5; ++i) {
+    values.push_back(std::make_unique<int>(i));
+  }
+
+  // Move-only values can only be reduced if they are not copied.
+  auto result = sync_wait(reduce_stream(
+      element_stream<std::unique_ptr<int>>{values},
+      std::size_t{0},
+      [&](std::size_t index, const std::unique_ptr<int>& value) {
+        EXPECT_EQ(&value, &values[index]);
+        EXPECT_EQ(*value, static_cast<int>(index));
+        return index + 1;
+      }));
+
+  EXPECT_EQ(result.value(), 5u);
+  for (auto& value : values) {
+    EXPECT_NE(value, nullptr);
+  }
+}
+
+TEST(ReduceStream, NextOperationOutlivesReducer) {
+  int liveCount = 0;
+  auto result = sync_wait(reduce_stream(
+      operation_owned_stream{liveCount}, 0, [&](int sum, const int& value) {
+        // 'value' refers into the next() operation, which is only
+        // destroyed once the reducer has returned.
+        EXPECT_EQ(liveCount, 1);
+        return sum + value;
+      }));
+
+  EXPECT_EQ(result.value(), 55);
+  EXPECT_EQ(liveCount, 0);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/just.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/split.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform.hpp>
+#include <unifex/when_all.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+TEST(Split, RunsPredecessorOnce) {
+  single_thread_context thread;
+
+  std::atomic<int> runCount{0};
+  auto shared = split(transform(schedule(thread.get_scheduler()), [&] {
+    ++runCount;
+    return std::string{"result"};
+  }));
+
+  // Algorithms take ownership of their senders, so give each consumer
+  // its own copy of the split() sender.
+  auto consumer = [&] {
+    return transform(
+        decltype(shared){shared}, [](std::string s) { return s.size(); });
+  };
+  auto result = sync_wait(transform(
+      when_all(consumer(), consumer(), consumer()),
+      [](auto&& a, auto&& b, auto&& c) {
+        return std::get<0>(std::get<0>(a)) + std::get<0>(std::get<0>(b)) +
+            std::get<0>(std::get<0>(c));
+      }));
+  EXPECT_EQ(result.value(), 18u);
+  EXPECT_EQ(runCount.load(), 1);
+
+  // Subscribers that arrive after completion are served inline from the
+  // stored result.
+  EXPECT_EQ(sync_wait(decltype(shared){shared}).value(), "result");
+  EXPECT_EQ(runCount.load(), 1);
+}
+
+TEST(Split, Error) {
+  auto shared = split(transform(just(), []() -> int {
+    throw std::runtime_error{"error"};
+  }));
+  EXPECT_THROW(sync_wait(decltype(shared){shared}), std::runtime_error);
+  EXPECT_THROW(sync_wait(std::move(shared)), std::runtime_error);
+}
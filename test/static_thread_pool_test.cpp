@@ -56,3 +56,28 @@ TEST(StaticThreadPool, Smoke) {
 
   EXPECT_EQ(x, 3);
 }
+
+TEST(StaticThreadPool, ArenaAllocator) {
+  static_thread_pool tpContext{2};
+  auto tp = tpContext.get_scheduler();
+  auto alloc = get_allocator(tp);
+
+  // Allocations made on a worker thread come from that worker's arena and
+  // can be freed from any thread.
+  int* p = sync_wait(transform(schedule(tp), [&] {
+    int* x = std::allocator_traits<decltype(alloc)>::rebind_alloc<int>{alloc}
+        .allocate(1);
+    *x = 42;
+    return x;
+  })).value();
+  EXPECT_EQ(*p, 42);
+  std::allocator_traits<decltype(alloc)>::rebind_alloc<int>{alloc}
+      .deallocate(p, 1);
+
+  // Allocating from a thread that isn't a worker uses a shared arena.
+  std::allocator_traits<decltype(alloc)>::rebind_alloc<double> doubleAlloc{
+      alloc};
+  double* d = doubleAlloc.allocate(4);
+  d[3] = 1.0;
+  doubleAlloc.deallocate(d, 4);
+}
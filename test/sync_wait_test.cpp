@@ -0,0 +1,207 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/manual_event_loop.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/thread_unsafe_event_loop.hpp>
+#include <unifex/transform.hpp>
+#include <unifex/typed_via.hpp>
+
+#include <system_error>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#if !UNIFEX_NO_COROUTINES
+#  include <unifex/awaitable_sender.hpp>
+#  include <unifex/sender_awaitable.hpp>
+#  include <unifex/task.hpp>
+#endif  // UNIFEX_NO_COROUTINES
+
+using namespace unifex;
+
+namespace {
+// Completes inline with set_error(std::errc::no_such_file_or_directory).
+template <blocking_kind Blocking>
+struct error_code_sender {
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<int>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code>;
+
+  template <typename Receiver>
+  struct operation {
+    Receiver receiver_;
+
+    void start() noexcept {
+      unifex::set_error(
+          std::move(receiver_),
+          std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+  };
+
+  template <typename Receiver>
+  operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+    return {(Receiver &&) r};
+  }
+
+  friend constexpr blocking_kind tag_invoke(
+      tag_t<blocking>, const error_code_sender&) noexcept {
+    return Blocking;
+  }
+};
+} // namespace
+
+TEST(SyncWait, CompletesOnAnotherThread) {
+  single_thread_context thread;
+
+  for (int i = 0; i < 10000; ++i) {
+    auto result = sync_wait(
+        transform(schedule(thread.get_scheduler()), [i] { return i; }));
+    ASSERT_EQ(result.value(), i);
+  }
+}
+
+TEST(SyncWaitOn, ManualEventLoopRunsScheduledWorkInline) {
+  manual_event_loop loop;
+
+  // schedule() with no scheduler schedules onto the receiver's scheduler.
+  auto id = sync_wait_on(
+      loop, transform(schedule(), [] { return std::this_thread::get_id(); }));
+
+  EXPECT_EQ(id.value(), std::this_thread::get_id());
+}
+
+TEST(SyncWaitOn, ManualEventLoopCompletesFromAnotherThread) {
+  manual_event_loop loop;
+  single_thread_context thread;
+
+  const auto threadId =
+      sync_wait(transform(schedule(thread.get_scheduler()), [] {
+        return std::this_thread::get_id();
+      }));
+
+  auto ids = sync_wait_on(
+      loop,
+      transform(
+          typed_via(
+              transform(
+                  schedule(thread.get_scheduler()),
+                  [] { return std::this_thread::get_id(); }),
+              loop.get_scheduler()),
+          [](std::thread::id producer) {
+            return std::make_pair(producer, std::this_thread::get_id());
+          }));
+
+  EXPECT_EQ(ids->first, threadId.value());
+  EXPECT_EQ(ids->second, std::this_thread::get_id());
+
+  // Completing directly on the other thread also wakes the loop.
+  EXPECT_TRUE(sync_wait_on(loop, schedule(thread.get_scheduler())));
+}
+
+TEST(SyncWaitOn, ManualEventLoopRunConcurrently) {
+  manual_event_loop loop;
+  std::thread runner{[&] { loop.run(); }};
+
+  // Either thread may execute the task that completes each sync_wait().
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_TRUE(sync_wait_on(loop, schedule(loop.get_scheduler())));
+  }
+
+  loop.stop();
+  runner.join();
+}
+
+TEST(SyncWaitOn, ThreadUnsafeEventLoop) {
+  thread_unsafe_event_loop loop;
+
+  auto result = sync_wait_on(loop, transform(schedule(), [] { return 42; }));
+
+  EXPECT_EQ(result.value(), 42);
+}
+
+TEST(SyncWaitOrError, ReturnsDeclaredErrorWithoutThrowing) {
+  auto inlineResult =
+      sync_wait_or_error(error_code_sender<blocking_kind::always_inline>{});
+  static_assert(std::is_same_v<
+                decltype(inlineResult),
+                std::variant<
+                    std::optional<int>,
+                    std::error_code,
+                    std::exception_ptr>>);
+  ASSERT_EQ(inlineResult.index(), 1u);
+  EXPECT_EQ(
+      std::get<1>(inlineResult),
+      std::make_error_code(std::errc::no_such_file_or_directory));
+
+  auto result = sync_wait_or_error(error_code_sender<blocking_kind::maybe>{});
+  ASSERT_EQ(result.index(), 1u);
+  EXPECT_EQ(std::get<1>(result), std::get<1>(inlineResult));
+
+  auto value = sync_wait_or_error(
+      transform(schedule(inline_scheduler{}), [] { return 42; }));
+  ASSERT_EQ(value.index(), 0u);
+  EXPECT_EQ(std::get<0>(value).value(), 42);
+}
+
+TEST(SyncWait, ThrowsDeclaredErrorByValue) {
+  EXPECT_THROW(
+      sync_wait(error_code_sender<blocking_kind::maybe>{}), std::error_code);
+}
+
+TEST(SyncWaitOn, ManualEventLoopThrowsDeclaredErrorByValue) {
+  manual_event_loop loop;
+  EXPECT_THROW(
+      sync_wait_on(loop, error_code_sender<blocking_kind::maybe>{}),
+      std::error_code);
+}
+
+#if !UNIFEX_NO_COROUTINES
+TEST(AwaitOrError, ReturnsDeclaredErrorWithoutThrowing) {
+  auto makeTask = []() -> task<std::error_code> {
+    auto result = co_await await_or_error(
+        error_code_sender<blocking_kind::maybe>{});
+    static_assert(std::is_same_v<
+                  decltype(result),
+                  std::variant<
+                      std::optional<int>,
+                      std::error_code,
+                      std::exception_ptr>>);
+    if (auto* error = std::get_if<std::error_code>(&result)) {
+      co_return *error;
+    }
+    co_return std::error_code{};
+  };
+
+  auto error = sync_wait(awaitable_sender(makeTask()));
+  EXPECT_EQ(
+      error.value(),
+      std::make_error_code(std::errc::no_such_file_or_directory));
+
+  auto makeValueTask = []() -> task<int> {
+    auto result = co_await await_or_error(
+        transform(schedule(inline_scheduler{}), [] { return 42; }));
+    co_return result.index() == 0 ? *std::get<0>(result) : -1;
+  };
+  EXPECT_EQ(sync_wait(awaitable_sender(makeValueTask())).value(), 42);
+}
+#endif  // UNIFEX_NO_COROUTINES
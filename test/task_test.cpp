@@ -0,0 +1,131 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#include <unifex/awaitable_sender.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/task.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+struct allocation_counts {
+  int allocated = 0;
+  int deallocated = 0;
+};
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(allocation_counts& counts) noexcept
+    : counts_(&counts) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : counts_(other.counts_) {}
+
+  T* allocate(std::size_t n) {
+    ++counts_->allocated;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    ++counts_->deallocated;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  friend bool operator==(
+      const counting_allocator& a, const counting_allocator& b) noexcept {
+    return a.counts_ == b.counts_;
+  }
+
+  friend bool operator!=(
+      const counting_allocator& a, const counting_allocator& b) noexcept {
+    return a.counts_ != b.counts_;
+  }
+
+  allocation_counts* counts_;
+};
+
+task<void> add_down_to_zero(int depth, int& sum) {
+  if (depth > 0) {
+    sum += depth;
+    co_await add_down_to_zero(depth - 1, sum);
+  }
+}
+
+task<void> throw_at_zero(int depth) {
+  if (depth == 0) {
+    throw std::runtime_error("zero");
+  }
+  co_await throw_at_zero(depth - 1);
+}
+
+task<int> allocated_chain(
+    std::allocator_arg_t, counting_allocator<std::byte> a, int depth) {
+  if (depth == 0) {
+    co_return 0;
+  }
+  co_return depth + co_await allocated_chain(std::allocator_arg, a, depth - 1);
+}
+
+struct adder {
+  task<int>
+  add(std::allocator_arg_t, counting_allocator<std::byte>, int value) const {
+    co_return base_ + value;
+  }
+
+  int base_;
+};
+} // namespace
+
+TEST(Task, Void) {
+  int sum = 0;
+  sync_wait(awaitable_sender(add_down_to_zero(10, sum)));
+  EXPECT_EQ(sum, 55);
+
+  EXPECT_THROW(
+      sync_wait(awaitable_sender(throw_at_zero(3))), std::runtime_error);
+}
+
+TEST(Task, AllocatorArgFrames) {
+  allocation_counts counts;
+  counting_allocator<std::byte> a{counts};
+
+  auto result =
+      sync_wait(awaitable_sender(allocated_chain(std::allocator_arg, a, 10)));
+  EXPECT_EQ(result.value(), 55);
+  EXPECT_EQ(counts.allocated, 11);
+  EXPECT_EQ(counts.deallocated, 11);
+
+  // Member functions are passed the object before std::allocator_arg.
+  adder add{100};
+  result = sync_wait(awaitable_sender(add.add(std::allocator_arg, a, 1)));
+  EXPECT_EQ(result.value(), 101);
+  EXPECT_EQ(counts.allocated, 12);
+  EXPECT_EQ(counts.deallocated, 12);
+}
+
+#endif  // UNIFEX_NO_COROUTINES
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform_stream_concurrent.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+auto append = [](std::vector<int> state, int value) {
+  state.push_back(value);
+  return state;
+};
+} // namespace
+
+TEST(TransformStreamConcurrent, Ordered) {
+  static_thread_pool pool{4};
+
+  auto values = sync_wait(reduce_stream(
+      transform_stream_concurrent(
+          range_stream{0, 100}, pool.get_scheduler(), 8, [](int value) {
+            return value * value;
+          }),
+      std::vector<int>{},
+      append));
+
+  ASSERT_EQ(values->size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ((*values)[i], i * i);
+  }
+}
+
+TEST(TransformStreamConcurrent, Unordered) {
+  static_thread_pool pool{4};
+
+  auto values = sync_wait(reduce_stream(
+      transform_stream_concurrent_unordered(
+          range_stream{0, 100}, pool.get_scheduler(), 8, [](int value) {
+            return value * value;
+          }),
+      std::vector<int>{},
+      append));
+
+  ASSERT_EQ(values->size(), 100u);
+  std::sort(values->begin(), values->end());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ((*values)[i], i * i);
+  }
+}
+
+TEST(TransformStreamConcurrent, Error) {
+  static_thread_pool pool{4};
+
+  EXPECT_THROW(
+      sync_wait(reduce_stream(
+          transform_stream_concurrent(
+              range_stream{0, 100},
+              pool.get_scheduler(),
+              8,
+              [](int value) {
+                if (value == 42) {
+                  throw std::runtime_error{"failed"};
+                }
+                return value;
+              }),
+          std::vector<int>{},
+          append)),
+      std::runtime_error);
+}
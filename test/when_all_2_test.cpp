@@ -13,6 +13,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <unifex/just.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sync_wait.hpp>
 #include <unifex/timed_single_thread_context.hpp>
@@ -20,7 +21,11 @@
 #include <unifex/when_all.hpp>
 
 #include <chrono>
+#include <exception>
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <variant>
 
 #include <gtest/gtest.h>
 
@@ -30,6 +35,45 @@ using namespace std::chrono_literals;
 
 struct my_error {};
 
+namespace {
+// A sender that may produce either an int or a std::string.
+struct int_or_string_sender {
+  template <
+      template <typename...> class Variant,
+      template <typename...> class Tuple>
+  using value_types = Variant<Tuple<int>, Tuple<std::string>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  template <typename Receiver>
+  struct operation {
+    Receiver receiver_;
+
+    void start() noexcept {
+      unifex::set_value(std::move(receiver_), std::string{"hello"});
+    }
+  };
+
+  template <typename Receiver>
+  operation<std::remove_cvref_t<Receiver>> connect(Receiver&& r) && {
+    return operation<std::remove_cvref_t<Receiver>>{(Receiver &&) r};
+  }
+};
+} // namespace
+
+TEST(WhenAll2, ValueTypes) {
+  auto result = sync_wait(transform(
+      when_all(just(42), int_or_string_sender{}),
+      [](auto&& a, auto&& b) {
+        EXPECT_EQ(a.index(), 0u);
+        EXPECT_EQ(std::get<0>(std::get<0>(a)), 42);
+        EXPECT_EQ(b.index(), 1u);
+        return std::get<0>(std::get<1>(b));
+      }));
+  EXPECT_EQ(result.value(), "hello");
+}
+
 TEST(WhenAll2, Smoke) {
   timed_single_thread_context context;
 
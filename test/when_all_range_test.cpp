@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/just.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform.hpp>
+#include <unifex/unstoppable_token.hpp>
+#include <unifex/when_all_range.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+TEST(WhenAllRange, CollectsValuesInOrder) {
+  static_thread_pool pool{4};
+  auto sched = pool.get_scheduler();
+
+  auto makeSender = [&](int i) {
+    return transform(schedule(sched), [i] { return i * i; });
+  };
+  std::vector<decltype(makeSender(0))> senders;
+  for (int i = 0; i < 100; ++i) {
+    senders.push_back(makeSender(i));
+  }
+
+  std::optional<std::vector<int>> result =
+      sync_wait(when_all_range(std::move(senders)));
+  ASSERT_TRUE(result);
+  ASSERT_EQ(result->size(), 100u);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ((*result)[i], i * i);
+  }
+}
+
+TEST(WhenAllRange, CollectsBoolsConcurrently) {
+  static_thread_pool pool{4};
+  auto sched = pool.get_scheduler();
+
+  auto makeSender = [&](int i) {
+    return transform(schedule(sched), [i] { return i % 3 == 0; });
+  };
+  std::vector<decltype(makeSender(0))> senders;
+  for (int i = 0; i < 1000; ++i) {
+    senders.push_back(makeSender(i));
+  }
+
+  std::optional<std::vector<bool>> result =
+      sync_wait(when_all_range(std::move(senders)));
+  ASSERT_TRUE(result);
+  ASSERT_EQ(result->size(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ((*result)[i], i % 3 == 0);
+  }
+}
+
+TEST(WhenAllRange, Empty) {
+  std::vector<decltype(just(1))> senders;
+  auto result = sync_wait(when_all_range(std::move(senders)));
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(result->empty());
+}
+
+TEST(WhenAllRange, ErrorCancelsOtherChildren) {
+  timed_single_thread_context context;
+  auto sched = context.get_scheduler();
+
+  auto makeSender = [&](int i) {
+    return transform(schedule_after(sched, i == 0 ? 1ms : 10s), [i]() -> int {
+      if (i == 0) {
+        throw std::runtime_error{"error"};
+      }
+      return i;
+    });
+  };
+  std::vector<decltype(makeSender(0))> senders;
+  for (int i = 0; i < 3; ++i) {
+    senders.push_back(makeSender(i));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_THROW(sync_wait(when_all_range(std::move(senders))), std::runtime_error);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(WhenAllRange, UnstoppableReceiver) {
+  static_thread_pool pool{2};
+  auto sched = pool.get_scheduler();
+
+  auto makeSender = [&](int i) {
+    return transform(schedule(sched), [i] { return i; });
+  };
+  std::vector<decltype(makeSender(0))> senders;
+  for (int i = 0; i < 10; ++i) {
+    senders.push_back(makeSender(i));
+  }
+
+  // No stop callback is registered on a token that can never be stopped.
+  auto result =
+      sync_wait(when_all_range(std::move(senders)), unstoppable_token{});
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->size(), 10u);
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019-present Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/just.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform.hpp>
+#include <unifex/when_any.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+TEST(WhenAny, FirstValueWinsAndLosersAreCancelled) {
+  timed_single_thread_context context;
+  auto sched = context.get_scheduler();
+
+  auto start = std::chrono::steady_clock::now();
+  std::optional<int> result = sync_wait(when_any(
+      transform(schedule_after(sched, 10s), [] { return 1; }),
+      transform(schedule_after(sched, 1ms), [] { return 2; })));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 2);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(WhenAny, ValueIsPreferredOverError) {
+  timed_single_thread_context context;
+  auto sched = context.get_scheduler();
+
+  std::optional<int> result = sync_wait(when_any(
+      transform(schedule_after(sched, 1ms), []() -> int {
+        throw std::runtime_error{"error"};
+      }),
+      transform(schedule_after(sched, 10ms), [] { return 2; })));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 2);
+}
+
+TEST(WhenAny, ErrorIfNoValue) {
+  EXPECT_THROW(
+      sync_wait(when_any(transform(just(), []() -> int {
+        throw std::runtime_error{"error"};
+      }))),
+      std::runtime_error);
+}
+
+TEST(WhenAnyRange, FirstValueWins) {
+  timed_single_thread_context context;
+  auto sched = context.get_scheduler();
+
+  auto makeSender = [&](int i) {
+    return transform(
+        schedule_after(sched, i == 3 ? 1ms : 10s), [i] { return i; });
+  };
+  std::vector<decltype(makeSender(0))> senders;
+  for (int i = 0; i < 5; ++i) {
+    senders.push_back(makeSender(i));
+  }
+
+  std::optional<int> result = sync_wait(when_any_range(std::move(senders)));
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 3);
+}